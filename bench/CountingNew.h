@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions with malloc/free wrappers that count every
+// allocation. Include it in one translation unit only, since it defines the replacements.
+// Every form of new and delete is replaced, so the pairs always match. The deletes free through
+// one out-of-line function, so GCC never sees free() called on a pointer from new and warns.
+inline std::atomic<std::uint64_t> heapAllocations{0};
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size);
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return ::operator new(size, tag); }
+
+[[gnu::noinline]] inline void CountingFree(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p) noexcept { CountingFree(p); }
+void operator delete(void* p, std::size_t) noexcept { CountingFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { CountingFree(p); }
+void operator delete[](void* p) noexcept { CountingFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { CountingFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { CountingFree(p); }
@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Fixed-memory, log-linear latency histogram in the style of HdrHistogram: values up to
+// highestTrackable are kept to significantDigits decimal digits of precision, recording is O(1)
+// (a bit scan and an increment) and percentiles walk the counts once.
+// Values are whatever unit the caller records; the benches use nanoseconds.
+class HdrHistogram {
+private:
+    std::uint64_t highestTrackable_;
+    int subBucketHalfCountMagnitude_;
+    std::uint64_t subBucketHalfCount_;
+    std::uint64_t subBucketMask_;
+    std::vector<std::uint64_t> counts_;
+
+    std::uint64_t total_{0};
+    std::uint64_t min_{UINT64_MAX};
+    std::uint64_t max_{0};
+    long double sum_{0};
+
+    int BucketIndex(std::uint64_t value) const {
+        int pow2Ceiling = 64 - std::countl_zero(value | subBucketMask_);
+        return pow2Ceiling - (subBucketHalfCountMagnitude_ + 1);
+    }
+
+    std::size_t CountsIndex(std::uint64_t value) const {
+        int bucket = BucketIndex(value);
+        std::uint64_t subBucket = value >> bucket;
+        return (static_cast<std::size_t>(bucket + 1) << subBucketHalfCountMagnitude_) + (subBucket - subBucketHalfCount_);
+    }
+
+    // Largest value that lands in the same slot as counts_[index]
+    std::uint64_t HighestEquivalentValue(std::size_t index) const {
+        int bucket = static_cast<int>(index >> subBucketHalfCountMagnitude_) - 1;
+        std::uint64_t subBucket = (index & (subBucketHalfCount_ - 1)) + subBucketHalfCount_;
+        if (bucket < 0) {
+            bucket = 0;
+            subBucket -= subBucketHalfCount_;
+        }
+        return (subBucket << bucket) + (std::uint64_t{ 1 } << bucket) - 1;
+    }
+
+public:
+    explicit HdrHistogram(std::uint64_t highestTrackable = std::uint64_t{ 1 } << 36, int significantDigits = 3)
+        : highestTrackable_{ highestTrackable }
+    {
+        auto largestSingleUnitResolution = static_cast<std::uint64_t>(2 * std::pow(10, significantDigits));
+        std::uint64_t subBucketCount = std::bit_ceil(largestSingleUnitResolution);
+        subBucketHalfCountMagnitude_ = std::countr_zero(subBucketCount) - 1;
+        subBucketHalfCount_ = subBucketCount / 2;
+        subBucketMask_ = subBucketCount - 1;
+
+        std::size_t buckets = 1;
+        for (std::uint64_t smallestUntrackable = subBucketCount; smallestUntrackable <= highestTrackable; smallestUntrackable <<= 1) ++buckets;
+        counts_.assign((buckets + 1) * subBucketHalfCount_, 0);
+    }
+
+    void Record(std::uint64_t value) {
+        value = std::min(value, highestTrackable_);
+        ++counts_[CountsIndex(value)];
+        ++total_;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        sum_ += value;
+    }
+
+    void Merge(const HdrHistogram& other) {
+        for (std::size_t i = 0; i < counts_.size() && i < other.counts_.size(); ++i) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        sum_ += other.sum_;
+    }
+
+    void Reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+        sum_ = 0;
+    }
+
+    std::uint64_t Count() const { return total_; }
+    std::uint64_t Min() const { return total_ ? min_ : 0; }
+    std::uint64_t Max() const { return max_; }
+    double Mean() const { return total_ ? static_cast<double>(sum_ / total_) : 0.0; }
+
+    // Value at percentile p in [0, 100], to the histogram's precision; 100 is the exact maximum
+    std::uint64_t Percentile(double p) const {
+        if (total_ == 0) return 0;
+        if (p >= 100.0) return max_;
+        auto target = static_cast<std::uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total_)));
+        target = std::max<std::uint64_t>(target, 1);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= target) return std::min(HighestEquivalentValue(i), max_);
+        }
+        return max_;
+    }
+};
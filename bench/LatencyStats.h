@@ -0,0 +1,49 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Collects per-operation latencies in nanoseconds and prints percentiles
+class LatencyStats {
+private:
+    std::string name_;
+    std::vector<std::uint64_t> samples_;
+
+public:
+    explicit LatencyStats(std::string name, std::size_t expected = 0)
+        : name_{ std::move(name) }
+    {
+        samples_.reserve(expected);
+    }
+
+    void Record(std::uint64_t nanos) { samples_.push_back(nanos); }
+
+    std::uint64_t Percentile(double p) {
+        if (samples_.empty()) return 0;
+        std::size_t index = static_cast<std::size_t>(p / 100.0 * (samples_.size() - 1));
+        std::nth_element(samples_.begin(), samples_.begin() + index, samples_.end());
+        return samples_[index];
+    }
+
+    void Print(std::ostream& out = std::cout) {
+        out << std::left << std::setw(24) << name_ << std::right
+            << " n=" << std::setw(9) << samples_.size()
+            << " p50=" << std::setw(7) << Percentile(50)
+            << " p99=" << std::setw(7) << Percentile(99)
+            << " p99.9=" << std::setw(7) << Percentile(99.9)
+            << " max=" << std::setw(9) << Percentile(100) << " ns\n";
+    }
+};
+
+// Runs f and returns how long it took in nanoseconds
+template <typename F>
+std::uint64_t TimeNanos(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
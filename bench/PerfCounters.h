@@ -0,0 +1,77 @@
+#pragma once
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hardware cache-miss counters for the calling thread via perf_event_open, user space only.
+// Counters the kernel refuses (no PMU in a VM, perf_event_paranoid too high) read as unavailable
+// instead of failing the bench.
+class PerfCounters {
+private:
+    struct Counter {
+        std::string name_;
+        int fd_{-1};
+        std::uint64_t value_{0};
+    };
+
+    std::vector<Counter> counters_;
+
+    static std::uint64_t CacheConfig(std::uint64_t cache, std::uint64_t op, std::uint64_t result) {
+        return cache | (op << 8) | (result << 16);
+    }
+
+    void Open(std::string name, std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        counters_.push_back(Counter{ std::move(name), fd });
+    }
+
+public:
+    PerfCounters() {
+        Open("l1d_misses", PERF_TYPE_HW_CACHE,
+            CacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        Open("llc_misses", PERF_TYPE_HW_CACHE,
+            CacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        Open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    }
+
+    ~PerfCounters() {
+        for (auto& counter : counters_)
+            if (counter.fd_ >= 0) close(counter.fd_);
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    void Start() {
+        for (auto& counter : counters_) {
+            if (counter.fd_ < 0) continue;
+            ioctl(counter.fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter.fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void Stop() {
+        for (auto& counter : counters_) {
+            if (counter.fd_ < 0) continue;
+            ioctl(counter.fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(counter.fd_, &counter.value_, sizeof(counter.value_)) != sizeof(counter.value_)) counter.value_ = 0;
+        }
+    }
+
+    // Calls f(name, value, available) for each counter, in a fixed order
+    template <typename F>
+    void ForEach(F&& f) const {
+        for (const auto& counter : counters_) f(counter.name_, counter.value_, counter.fd_ >= 0);
+    }
+};
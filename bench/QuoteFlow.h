@@ -0,0 +1,66 @@
+#pragma once
+#include "orderbook.h"
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+// The quote-like flow several benches replay: GoodTillCancel adds within 20 ticks of a fixed mid
+// and cancels of random live orders, with a share of adds priced through the touch so they
+// trade. Percentages are of all commands once the book holds targetDepth_ orders; until then
+// every command not otherwise assigned is an add.
+struct QuoteFlowConfig {
+    std::size_t targetDepth_{20'000};
+    unsigned addPercent_{60};          // resting adds, crossing ones included
+    unsigned crossPercent_{12};        // adds priced crossDistance_ through the mid
+    unsigned shortLivedPercent_{0};    // adds cancelled 1-8 commands later, on top of addPercent_
+    Price mid_{1000};
+    Price crossDistance_{5};
+};
+
+inline std::vector<Command> MakeQuoteFlow(std::size_t count, std::uint64_t seed, const QuoteFlowConfig& config = {}) {
+    std::mt19937_64 gen{ seed };
+    std::uniform_int_distribution<Price> offset(1, 20);
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+    std::vector<Command> commands;
+    commands.reserve(count);
+    std::vector<OrderId> live;
+    std::vector<std::pair<std::size_t, OrderId>> pending;   // (due index, id) of short-lived quotes
+    OrderId nextId = 1;
+
+    while (commands.size() < count) {
+        if (!pending.empty() && pending.front().first <= commands.size()) {
+            commands.push_back(Command::Cancel(pending.front().second));
+            pending.erase(pending.begin());
+            continue;
+        }
+        auto roll = gen() % 100;
+        Side side = gen() % 2 ? Side::BID : Side::ASK;
+        Price price = side == Side::BID ? config.mid_ - offset(gen) : config.mid_ + offset(gen);
+        if (roll < config.shortLivedPercent_) {
+            commands.push_back(Command::Add(Order(nextId, price, qty(gen), side, OrderType::GoodTillCancel)));
+            pending.push_back({ commands.size() + 1 + gen() % 8, nextId++ });
+            continue;
+        }
+        roll -= config.shortLivedPercent_;
+        if (roll < config.addPercent_ || live.size() < config.targetDepth_) {
+            if (roll < config.crossPercent_) price = side == Side::BID ? config.mid_ + config.crossDistance_ : config.mid_ - config.crossDistance_;
+            commands.push_back(Command::Add(Order(nextId, price, qty(gen), side, OrderType::GoodTillCancel)));
+            live.push_back(nextId++);
+        } else {
+            std::size_t pick = gen() % live.size();
+            commands.push_back(Command::Cancel(live[pick]));
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+    return commands;
+}
+
+// A dense book spanning 100 ticks either side of the flow's mid, reserved for its depth
+template <typename Book = OrderBook>
+Book MakeQuoteBook(const QuoteFlowConfig& config = {}) {
+    Book book{ LadderConfig{ config.mid_ - 100, 1, 200 } };
+    book.ReserveOrders(config.targetDepth_ * 4);
+    return book;
+}
@@ -0,0 +1,113 @@
+// Cost of streaming analytics on the matching thread: the same quote-like flow through a book
+// alone and through a book feeding MarketAnalytics the way the engine does (every command's
+// trades, then once per batch the clock, the top five levels and a publish). A last run adds a
+// reader thread loading snapshots throughout and checks that none is torn. Time advances 1us per
+// command, so bars and the VWAP window roll over many times. Also reports the cost of each
+// analytics call on its own.
+// build: g++ -std=c++20 -O3 -pthread -Isrc -Ibench bench/analytics_bench.cpp -o analytics_bench
+// usage: analytics_bench [commands] [batch size]    (default 4M, 256)
+#include "Analytics.h"
+#include "orderbook.h"
+#include "LatencyStats.h"
+#include "QuoteFlow.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+constexpr Timestamp kStart = 1'700'000'000'000'000'000ll;
+constexpr Timestamp kTick = 1'000;   // per command
+constexpr int kRounds = 5;
+
+// ns per command; analytics may be null
+double Replay(const std::vector<Command>& commands, std::size_t batchSize, MarketAnalytics* analytics, std::uint64_t& volume) {
+    OrderBook book = MakeQuoteBook();
+    Trades trades;
+    trades.reserve(1'024);
+    volume = 0;
+    auto elapsed = TimeNanos([&] {
+        Timestamp now = kStart;
+        for (std::size_t i = 0; i < commands.size(); ++i) {
+            trades.clear();
+            book.Apply(commands[i], trades);
+            now += kTick;
+            for (const auto& trade : trades) volume += trade.GetQuantity();
+            if (!analytics) continue;
+            analytics->OnTrades(trades, now);
+            if ((i + 1) % batchSize == 0) {
+                analytics->Advance(now);
+                analytics->OnBook(book);
+                analytics->Publish();
+            }
+        }
+    });
+    return static_cast<double>(elapsed) / commands.size();
+}
+
+template <typename F>
+double NanosPerCall(std::size_t calls, F&& f) {
+    return static_cast<double>(TimeNanos([&] { for (std::size_t i = 0; i < calls; ++i) f(i); })) / calls;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    std::size_t batchSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 256;
+    std::vector<Command> commands = MakeQuoteFlow(count, 7);
+
+    double plain = 1e18, streamed = 1e18;
+    std::uint64_t plainVolume = 0, volume = 0;
+    AnalyticsSnapshot last;
+    std::uint64_t loads = 0, inconsistent = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        plain = std::min(plain, Replay(commands, batchSize, nullptr, plainVolume));
+        MarketAnalytics analytics;
+        streamed = std::min(streamed, Replay(commands, batchSize, &analytics, volume));
+    }
+
+    // once more with a reader, untimed: on a machine with a spare core it would not slow the writer
+    MarketAnalytics shared;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            AnalyticsSnapshot snapshot = shared.Load();
+            inconsistent += snapshot.current_[0].volume_ > snapshot.volume_ || snapshot.windowVolume_ > snapshot.volume_;
+            ++loads;
+        }
+    });
+    Replay(commands, batchSize, &shared, volume);
+    done.store(true);
+    reader.join();
+    shared.Publish();
+    last = shared.Load();
+    if (volume != plainVolume || last.volume_ != volume || inconsistent) {
+        std::cerr << "analytics disagree: traded " << volume << ", analytics " << last.volume_
+                  << ", inconsistent reads " << inconsistent << "\n";
+        return 1;
+    }
+
+    MarketAnalytics analytics;
+    OrderBook book = MakeQuoteBook();
+    for (std::size_t i = 0; i < 200'000; ++i) book.Apply(commands[i]);
+    constexpr std::size_t kCalls = 4'000'000;
+    double onTrade = NanosPerCall(kCalls, [&](std::size_t i) { analytics.OnTrade(1000 + static_cast<Price>(i % 7), 10, kStart + static_cast<Timestamp>(i) * kTick); });
+    double onBook = NanosPerCall(kCalls / 4, [&](std::size_t) { analytics.OnBook(book); });
+    double publish = NanosPerCall(kCalls / 4, [&](std::size_t) { analytics.Publish(); });
+    double load = NanosPerCall(kCalls / 4, [&](std::size_t) { analytics.Load(); });
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "commands: " << count << ", batch " << batchSize << ", trades " << last.trades_ << ", best of " << kRounds << "\n"
+              << "book only:        " << plain << " ns/cmd\n"
+              << "book + analytics: " << streamed << " ns/cmd (+" << 100.0 * (streamed - plain) / plain << "%)\n"
+              << "reader loads during the last run: " << loads << "\n"
+              << "vwap " << std::setprecision(3) << last.Vwap() << ", window vwap " << last.WindowVwap()
+              << ", L1 imbalance " << last.ImbalanceL1() << ", L5 imbalance " << last.ImbalanceL5() << "\n"
+              << std::setprecision(1)
+              << "OnTrade " << onTrade << " ns, OnBook " << onBook << " ns, Publish " << publish << " ns, Load " << load
+              << " ns\n";
+    return 0;
+}
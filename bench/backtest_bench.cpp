@@ -0,0 +1,77 @@
+// Backtest throughput across thread counts, with and without work stealing, on jobs whose sizes
+// follow a Zipf curve (the largest day is many times the median), which is where a static split
+// leaves stragglers. Jobs are written once as binary order files under a scratch directory.
+// build: g++ -std=c++20 -O3 -pthread -Isrc -Ibench bench/backtest_bench.cpp -o backtest_bench
+// usage: backtest_bench [jobs] [total commands] [scratch dir]    (default 64, 8M, $TMPDIR/backtest_bench)
+#include "Backtest.h"
+#include "QuoteFlow.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+constexpr std::size_t kTargetDepth = 5'000;
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t jobs = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    std::size_t total = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8'000'000;
+    std::filesystem::path scratch = argc > 3 ? std::filesystem::path{ argv[3] } : std::filesystem::temp_directory_path() / "backtest_bench";
+
+    std::filesystem::remove_all(scratch);
+    std::filesystem::create_directories(scratch / "in");
+    double harmonic = 0;
+    for (std::size_t j = 0; j < jobs; ++j) harmonic += 1.0 / (j + 1);
+    std::vector<std::filesystem::path> inputs;
+    std::size_t largest = 0;
+    for (std::size_t j = 0; j < jobs; ++j) {
+        // shuffled so the big jobs are not also the first files in name order
+        std::size_t rank = (j * 37) % jobs;
+        auto count = std::max<std::size_t>(static_cast<std::size_t>(total / harmonic / (rank + 1)), 100);
+        largest = std::max(largest, count);
+        inputs.push_back(scratch / "in" / std::format("day{:04}.cmd", j));
+        QuoteFlowConfig flow{ .targetDepth_ = std::min(kTargetDepth, count / 4), .addPercent_ = 55, .crossPercent_ = 8 };
+        WriteOrderFile(inputs.back(), MakeQuoteFlow(count, j + 1, flow));
+    }
+
+    std::vector<std::size_t> threads{ 1 };
+    for (std::size_t t = 2; t < std::thread::hardware_concurrency(); t *= 2) threads.push_back(t);
+    if (std::thread::hardware_concurrency() > 1) threads.push_back(std::thread::hardware_concurrency());
+
+    std::cout << jobs << " jobs, " << total << " commands, largest job " << largest << " ("
+              << std::fixed << std::setprecision(1) << 100.0 * largest / total << "% of the work)\n"
+              << std::setw(8) << "threads" << std::setw(8) << "steal" << std::setw(14) << "events/s" << std::setw(10) << "speedup"
+              << std::setw(11) << "imbalance" << std::setw(8) << "steals" << "\n";
+    double base = 0;
+    std::uint64_t trades = 0;
+    for (std::size_t count : threads) {
+        for (bool stealing : { false, true }) {
+            if (count == 1 && !stealing) continue;
+            BacktestConfig config;
+            config.outputDirectory_ = scratch / "out";
+            config.pool_.threads_ = count;
+            config.pool_.stealing_ = stealing;
+            auto report = RunBacktest(config, inputs);
+            if (report.failed_) {
+                std::cerr << report.failed_ << " jobs failed\n";
+                return 1;
+            }
+            if (trades && report.trades_ != trades) {
+                std::cerr << "trade count changed with " << count << " threads: " << report.trades_ << " vs " << trades << "\n";
+                return 1;
+            }
+            trades = report.trades_;
+            std::size_t steals = 0;
+            for (const auto& worker : report.pool_.workers_) steals += worker.steals_;
+            double rate = report.EventsPerSecond();
+            if (base == 0) base = rate;
+            std::cout << std::setw(8) << count << std::setw(8) << (stealing ? "on" : "off") << std::setw(14) << static_cast<std::uint64_t>(rate)
+                      << std::setw(10) << std::setprecision(2) << rate / base << std::setw(11) << report.pool_.Imbalance()
+                      << std::setw(8) << steals << "\n";
+        }
+    }
+    std::filesystem::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Throughput of OrderBook::ProcessBatch by batch size against one ApplyCommand call per command.
+// The flow is quote-like: resting adds and cancels around the touch, a share of adds cancelled a
+// few commands later (the pairs a batch can collapse) and the occasional crossing order.
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/batch_bench.cpp -o batch_bench
+// usage: batch_bench [commands] [seed]
+#include "orderbook.h"
+#include "LatencyStats.h"
+#include "QuoteFlow.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Half the adds are cancelled a few commands later, the pairs a batch can collapse
+constexpr QuoteFlowConfig kFlow{ .addPercent_ = 35, .crossPercent_ = 3, .shortLivedPercent_ = 35, .crossDistance_ = 10 };
+
+constexpr int kRounds = 5;
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 7;
+    std::vector<Command> commands = MakeQuoteFlow(count, seed, kFlow);
+
+    // Rounds interleave the configurations so drift in machine speed hits them all alike
+    const std::vector<std::size_t> batches{ 0, 1, 4, 16, 64, 256, 1024, 4096 };   // 0 = per call
+    std::vector<double> rates(batches.size(), 0);
+    std::vector<std::size_t> trades(batches.size()), collapsed(batches.size()), deltas(batches.size());
+    for (int round = 0; round < kRounds; ++round) {
+        for (std::size_t b = 0; b < batches.size(); ++b) {
+            OrderBook book = MakeQuoteBook(kFlow);
+            std::size_t batch = batches[b];
+            trades[b] = collapsed[b] = deltas[b] = 0;
+            std::uint64_t elapsed;
+            if (batch == 0) {
+                LevelUpdates updates;
+                book.SetLevelUpdateSink(&updates);
+                elapsed = TimeNanos([&] {
+                    for (const auto& command : commands) {
+                        trades[b] += ApplyCommand(book, command).size();
+                        deltas[b] += updates.size();
+                        updates.clear();
+                    }
+                });
+            } else {
+                BatchResult result;
+                elapsed = TimeNanos([&] {
+                    for (std::size_t i = 0; i < count; i += batch) {
+                        result.Clear();
+                        book.ProcessBatch(std::span{ commands }.subspan(i, std::min(batch, count - i)), result);
+                        trades[b] += result.trades_.size();
+                        collapsed[b] += result.collapsed_;
+                        deltas[b] += result.levelUpdates_.size();
+                    }
+                });
+            }
+            rates[b] = std::max(rates[b], count * 1e3 / elapsed);
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "commands: " << count << ", trades: " << trades[0] << ", best of " << kRounds << "\n"
+              << std::setw(8) << "batch" << std::setw(12) << "Mcmd/s" << std::setw(10) << "speedup"
+              << std::setw(12) << "collapsed" << std::setw(12) << "deltas/cmd" << "\n";
+    for (std::size_t b = 0; b < batches.size(); ++b) {
+        if (trades[b] != trades[0]) {
+            std::cerr << "batch " << batches[b] << " produced " << trades[b] << " trades, expected " << trades[0] << "\n";
+            return 1;
+        }
+        std::cout << std::setw(8) << (batches[b] == 0 ? std::string{ "percall" } : std::to_string(batches[b]))
+                  << std::setw(12) << rates[b] << std::setw(10) << rates[b] / rates[0]
+                  << std::setw(12) << collapsed[b] << std::setw(12) << static_cast<double>(deltas[b]) / count << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Liquidity queries on a dense side: how far a sweep of Q reaches (the FillOrKill check) and
+// depth within N ticks, answered by walking the levels as the book used to and by the
+// QuantityKernels reductions over the ladder's quantity array. Build variants to compare widths:
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/depth_bench.cpp -o depth_bench                      (sse2)
+//        g++ -std=c++20 -O3 -mavx2 -Isrc -Ibench bench/depth_bench.cpp -o depth_bench_avx2
+//        g++ -std=c++20 -O3 -DORDERBOOK_SIMD=0 -Isrc -Ibench bench/depth_bench.cpp -o depth_bench_scalar
+// usage: depth_bench [levels] [fill%]        (default 16384 ticks per side, 80% of them quoted)
+#include "PriceLevels.h"
+#include "LatencyStats.h"
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+
+namespace {
+
+constexpr std::size_t kQueries = 200'000;
+
+template <Side S>
+PriceLevels<S> MakeSide(std::size_t ticks, unsigned fill) {
+    std::mt19937_64 gen{ 11 };
+    PriceLevels<S> side{ LadderConfig{ 0, 1, ticks } };
+    for (std::size_t i = 0; i < ticks; ++i) {
+        if (gen() % 100 >= fill) continue;
+        side.AddQuantity(side.GetOrCreate(static_cast<Price>(i)), 1 + static_cast<Quantity>(gen() % 500));
+    }
+    return side;
+}
+
+template <Side S>
+std::optional<Price> WalkSweepPrice(const PriceLevels<S>& side, std::uint64_t quantity) {
+    std::uint64_t available = 0;
+    Price reached = 0;
+    side.ForEachLevel([&](Price price, const PriceLevel& level) {
+        available += level.quantity_;
+        reached = price;
+        return available < quantity;
+    });
+    return available >= quantity ? std::optional{ reached } : std::nullopt;
+}
+
+template <Side S>
+std::uint64_t WalkDepthWithin(const PriceLevels<S>& side, Price distance) {
+    Price limit = S == Side::BID ? side.BestPrice() - distance : side.BestPrice() + distance;
+    std::uint64_t depth = 0;
+    side.ForEachLevel([&](Price price, const PriceLevel& level) {
+        if (S == Side::BID ? price < limit : price > limit) return false;
+        depth += level.quantity_;
+        return true;
+    });
+    return depth;
+}
+
+void Print(const char* side, const char* query, std::size_t reach, double walkNanos, double kernelNanos) {
+    std::cout << std::setw(5) << side << std::setw(8) << query << std::setw(8) << reach << std::fixed << std::setprecision(1)
+              << std::setw(12) << walkNanos << std::setw(12) << kernelNanos
+              << std::setw(10) << walkNanos / kernelNanos << "x\n";
+}
+
+template <Side S>
+bool Run(const char* name, std::size_t ticks, unsigned fill) {
+    PriceLevels<S> side = MakeSide<S>(ticks, fill);
+    bool ok = true;
+    std::uintptr_t sink = 0;
+
+    // quantity reaching exactly `levels` quoted levels, so both methods do comparable work
+    for (std::size_t levels : { 4, 32, 256, 2048 }) {
+        std::uint64_t target = 0;
+        std::size_t counted = 0;
+        side.ForEachLevel([&](Price, const PriceLevel& level) {
+            target += level.quantity_;
+            return ++counted < levels;
+        });
+        ok = ok && WalkSweepPrice(side, target) == side.SweepPrice(target);
+        auto walk = TimeNanos([&] {
+            for (std::size_t i = 0; i < kQueries; ++i) sink += WalkSweepPrice(side, target - i % 2).value_or(0);
+        });
+        auto kernel = TimeNanos([&] {
+            for (std::size_t i = 0; i < kQueries; ++i) sink += side.SweepPrice(target - i % 2).value_or(0);
+        });
+        Print(name, "sweep", levels, walk / double(kQueries), kernel / double(kQueries));
+    }
+
+    for (Price distance : { 16, 128, 1024, 8192 }) {
+        ok = ok && WalkDepthWithin(side, distance) == side.DepthWithin(distance);
+        auto walk = TimeNanos([&] {
+            for (std::size_t i = 0; i < kQueries; ++i) sink += WalkDepthWithin(side, distance - static_cast<Price>(i % 2));
+        });
+        auto kernel = TimeNanos([&] {
+            for (std::size_t i = 0; i < kQueries; ++i) sink += side.DepthWithin(distance - static_cast<Price>(i % 2));
+        });
+        Print(name, "depth", static_cast<std::size_t>(distance), walk / double(kQueries), kernel / double(kQueries));
+    }
+    if (sink == 1) std::cout << "*";
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16384;
+    unsigned fill = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 80;
+
+    std::cout << "kernels: " << QuantityKernels::Name() << ", " << ticks << " ticks per side, " << fill << "% quoted\n"
+              << std::setw(5) << "side" << std::setw(8) << "query" << std::setw(8) << "reach"
+              << std::setw(12) << "walk ns" << std::setw(12) << "kernel ns" << std::setw(11) << "speedup\n";
+    bool ok = Run<Side::ASK>("ask", ticks, fill);
+    ok = Run<Side::BID>("bid", ticks, fill) && ok;
+    if (!ok) std::cout << "MISMATCH between walk and kernel results\n";
+    return ok ? 0 : 1;
+}
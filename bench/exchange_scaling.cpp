@@ -0,0 +1,107 @@
+// Throughput of the sharded Exchange for 1..N shards over a Zipf-skewed symbol mix.
+// build: g++ -std=c++20 -O3 -pthread -Isrc bench/exchange_scaling.cpp -o exchange_scaling
+// usage: exchange_scaling [maxShards] [producers]
+#include "Exchange.h"
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+constexpr Symbol kSymbols = 500;
+constexpr double kZipfExponent = 1.1;
+constexpr std::size_t kCommandsPerProducer = 2'000'000;
+
+// Probability of each symbol under Zipf(s): p(k) ~ 1 / k^s
+std::vector<double> ZipfWeights(std::size_t n, double s) {
+    std::vector<double> weights(n);
+    double total = 0;
+    for (std::size_t k = 0; k < n; ++k) total += weights[k] = 1.0 / std::pow(static_cast<double>(k + 1), s);
+    for (auto& w : weights) w /= total;
+    return weights;
+}
+
+// Adds around a fixed mid on every symbol, with a share of cancels of the producer's own recent orders
+std::vector<Command> MakeFlow(std::size_t producer, const std::vector<double>& weights) {
+    std::mt19937_64 gen{ 1000 + producer };
+    std::discrete_distribution<Symbol> symbol(weights.begin(), weights.end());
+    std::uniform_int_distribution<Price> price(90, 110);
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+
+    std::vector<Command> flow;
+    flow.reserve(kCommandsPerProducer);
+    std::vector<std::pair<OrderId, Symbol>> recent;
+    OrderId nextId = (static_cast<OrderId>(producer) << 40) + 1;
+
+    while (flow.size() < kCommandsPerProducer) {
+        if (!recent.empty() && gen() % 10 < 3) {
+            std::size_t pick = gen() % recent.size();
+            flow.push_back(Command::Cancel(recent[pick].first, recent[pick].second));
+            recent[pick] = recent.back();
+            recent.pop_back();
+            continue;
+        }
+        Symbol s = symbol(gen);
+        Side side = gen() % 2 ? Side::BID : Side::ASK;
+        flow.push_back(Command::Add(Order(nextId, price(gen), qty(gen), side, OrderType::GoodTillCancel), s));
+        recent.emplace_back(nextId++, s);
+        if (recent.size() > 4096) {
+            recent[gen() % recent.size()] = recent.back();
+            recent.pop_back();
+        }
+    }
+    return flow;
+}
+
+double Run(std::size_t shards, const std::vector<std::vector<Command>>& flows, const std::vector<double>& weights) {
+    ExchangeConfig config;
+    config.shards_ = shards;
+    config.pinThreads_ = true;
+    config.firstCpu_ = static_cast<int>(flows.size());   // producers take the first cores
+    Exchange exchange{ config };
+    for (Symbol s = 0; s < kSymbols; ++s) exchange.AddSymbol(s, OrderBook{}, weights[s]);
+    exchange.Start();
+
+    std::uint64_t total = 0;
+    for (const auto& flow : flows) total += flow.size();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < flows.size(); ++p) {
+        producers.emplace_back([&, p] {
+            PinCurrentThread(static_cast<int>(p));
+            for (const auto& command : flows[p]) exchange.Submit(command);
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    while (exchange.GetStats().commandsProcessed_ < total) std::this_thread::yield();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    exchange.Stop();
+    return total / seconds;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t cores = std::max(2u, std::thread::hardware_concurrency());
+    std::size_t producers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::max<std::size_t>(1, cores / 4);
+    std::size_t maxShards = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::max<std::size_t>(1, cores - producers);
+
+    auto weights = ZipfWeights(kSymbols, kZipfExponent);
+    std::vector<std::vector<Command>> flows;
+    for (std::size_t p = 0; p < producers; ++p) flows.push_back(MakeFlow(p, weights));
+
+    std::cout << "symbols=" << kSymbols << " zipf=" << kZipfExponent << " producers=" << producers << "\n";
+    double base = 0;
+    for (std::size_t shards = 1; shards <= maxShards; ++shards) {
+        double rate = Run(shards, flows, weights);
+        if (shards == 1) base = rate;
+        std::cout << "shards=" << std::setw(3) << shards
+                  << "  " << std::fixed << std::setprecision(2) << rate / 1e6 << " M cmd/s"
+                  << "  speedup=" << rate / base << "\n";
+    }
+    return 0;
+}
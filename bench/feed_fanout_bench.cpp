@@ -0,0 +1,128 @@
+// Fan-out latency of the binary market-data feed: one engine, one publisher, N subscribers.
+// Latency is measured per batch from the publisher's flush stamp to the subscriber having read
+// the whole batch, on the same host's steady clock.
+// build: g++ -std=c++20 -O3 -pthread -Isrc bench/feed_fanout_bench.cpp -o feed_fanout_bench
+// usage: feed_fanout_bench [subscribers] [unix|tcp]
+#include "MarketDataPublisher.h"
+#include "LatencyStats.h"
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+constexpr std::size_t kCommands = 500'000;
+
+struct SubscriberResult {
+    std::vector<std::uint64_t> latencies_;
+    std::uint64_t batches_{0};
+    std::uint64_t messages_{0};
+    std::uint64_t gaps_{0};
+    bool malformed_{false};
+};
+
+int Connect(Transport transport, const MarketDataPublisher& publisher) {
+    if (transport == Transport::Unix) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, publisher.GetPath().c_str(), sizeof(address.sun_path) - 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) throw std::system_error(errno, std::generic_category(), "connect");
+        return fd;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(publisher.GetPort());
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) throw std::system_error(errno, std::generic_category(), "connect");
+    return fd;
+}
+
+// Reads batches until the publisher closes the connection
+void Subscribe(int fd, SubscriberResult& result) {
+    std::vector<std::byte> buffer(1 << 20);
+    std::size_t filled = 0;
+    std::uint64_t lastSequence = 0;
+    while (true) {
+        ssize_t n = recv(fd, buffer.data() + filled, buffer.size() - filled, 0);
+        if (n <= 0) break;
+        filled += static_cast<std::size_t>(n);
+        std::int64_t now = NowNanos();
+        std::size_t offset = 0;
+        while (filled - offset >= sizeof(BatchHeader)) {
+            auto header = ReadMessage<BatchHeader>(buffer.data() + offset);
+            if (filled - offset < header.length_) break;
+            std::span<const std::byte> batch(buffer.data() + offset, header.length_);
+            if (!ForEachMessage(batch, [](const MessageHeader&, const std::byte*) { })) result.malformed_ = true;
+            if (lastSequence && header.batchSequence_ != lastSequence + 1) ++result.gaps_;
+            lastSequence = header.batchSequence_;
+            result.latencies_.push_back(static_cast<std::uint64_t>(now - header.sendTime_));
+            ++result.batches_;
+            result.messages_ += header.count_;
+            offset += header.length_;
+        }
+        std::memmove(buffer.data(), buffer.data() + offset, filled - offset);
+        filled -= offset;
+    }
+    close(fd);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t subscribers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 128;
+    Transport transport = argc > 2 && std::string(argv[2]) == "tcp" ? Transport::Tcp : Transport::Unix;
+
+    EngineConfig engineConfig;
+    engineConfig.outboundCapacity_ = 1 << 20;
+    MatchingEngine engine{ engineConfig };
+    PublisherConfig publisherConfig;
+    publisherConfig.transport_ = transport;
+    auto publisher = std::make_unique<MarketDataPublisher>(engine, publisherConfig);
+
+    std::vector<SubscriberResult> results(subscribers);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < subscribers; ++i) {
+        int fd = Connect(transport, *publisher);
+        threads.emplace_back([fd, &result = results[i]] { Subscribe(fd, result); });
+    }
+
+    engine.Start();
+    publisher->Start();
+    while (publisher->GetStats().clients_ < subscribers) std::this_thread::yield();
+
+    std::mt19937_64 gen{ 8 };
+    std::uniform_int_distribution<Price> price(95, 105);
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+    auto elapsed = TimeNanos([&] {
+        for (OrderId id = 1; id <= kCommands; ++id) {
+            Side side = gen() % 2 ? Side::BID : Side::ASK;
+            engine.Submit(Command::Add(Order(id, price(gen), qty(gen), side, OrderType::GoodTillCancel)));
+        }
+        while (engine.GetStats().commandsProcessed_ < kCommands) std::this_thread::yield();
+    });
+    engine.Stop();
+    publisher->Stop();
+    auto stats = publisher->GetStats();
+    publisher.reset();   // closes every connection, so subscribers see end of stream
+    for (auto& thread : threads) thread.join();
+
+    LatencyStats latency{ "batch fan-out" };
+    std::uint64_t gaps = 0, received = 0;
+    bool malformed = false;
+    for (const auto& result : results) {
+        for (auto nanos : result.latencies_) latency.Record(nanos);
+        gaps += result.gaps_;
+        received += result.messages_;
+        malformed |= result.malformed_;
+    }
+
+    std::cout << "transport=" << (transport == Transport::Tcp ? "tcp" : "unix") << " subscribers=" << subscribers
+              << " commands=" << kCommands << " cmd/s=" << static_cast<std::uint64_t>(kCommands * 1e9 / elapsed) << "\n"
+              << "batches=" << stats.batches_ << " messages=" << stats.messages_
+              << " bytes/subscriber=" << stats.bytesSent_ / std::max<std::size_t>(1, subscribers)
+              << " dropped=" << stats.batchesDropped_ << " disconnected=" << stats.slowConsumersDisconnected_
+              << " gaps=" << gaps << " delivered=" << received << "\n";
+    latency.Print();
+    return malformed ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+// Stress a single hot price level with 10M interleaved adds and cancels, cancelling from
+// random queue positions, then check the level aggregate against what is still live.
+// build: g++ -std=c++20 -O3 -Isrc bench/hot_level_stress.cpp -o hot_level_stress
+#include "orderbook.h"
+#include "LatencyStats.h"
+#include <random>
+
+namespace {
+
+constexpr std::size_t kOperations = 10'000'000;
+constexpr std::size_t kTargetDepth = 50'000;
+constexpr Price kPrice = 100;
+
+}
+
+int main() {
+    OrderBook book;
+    std::mt19937_64 gen{ 7 };
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+
+    LatencyStats adds{ "hot level add", kOperations / 2 };
+    LatencyStats cancels{ "hot level cancel", kOperations / 2 };
+
+    // live ids and their quantities, removed by swap-with-last so picks stay uniform
+    std::vector<std::pair<OrderId, Quantity>> live;
+    live.reserve(kTargetDepth * 2);
+    std::uint64_t liveQuantity = 0;
+    OrderId nextId = 1;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kOperations; ++i) {
+        // drift around the target depth so the queue stays deep
+        bool add = live.empty() || (live.size() < kTargetDepth ? gen() % 4 != 0 : gen() % 4 == 0);
+        if (add) {
+            Quantity q = qty(gen);
+            Order order(nextId, kPrice, q, Side::BID, OrderType::GoodTillCancel);
+            live.emplace_back(nextId++, q);
+            liveQuantity += q;
+            adds.Record(TimeNanos([&] { book.AddOrder(order); }));
+        } else {
+            std::size_t pick = gen() % live.size();
+            auto [id, q] = live[pick];
+            live[pick] = live.back();
+            live.pop_back();
+            liveQuantity -= q;
+            cancels.Record(TimeNanos([&] { book.CancelOrder(id); }));
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto level = book.GetBids(1);
+    std::uint64_t bookQuantity = level.empty() ? 0 : level[0].quantity_;
+    if (bookQuantity != liveQuantity || (level.empty() != live.empty())) {
+        std::cerr << "MISMATCH: book has " << bookQuantity << " resting, expected " << liveQuantity << "\n";
+        return 1;
+    }
+
+    adds.Print();
+    cancels.Print();
+    std::cout << kOperations / elapsed << " ops/sec, " << live.size() << " orders left on the level\n";
+    return 0;
+}
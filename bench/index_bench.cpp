@@ -0,0 +1,101 @@
+// OrderIndex against std::unordered_map<OrderId, Order*> holding N live orders with dense,
+// increasing ids: ns per insert (building to N), hit lookup, miss lookup and cancel/replace churn
+// (erase a random live id, insert the next id), plus table bytes per order.
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/index_bench.cpp -o index_bench
+// usage: index_bench [live...]        (default 1000000 10000000)
+#include "OrderIndex.h"
+#include "LatencyStats.h"
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kOps = 2'000'000;
+
+// Stand-in order pointers: never dereferenced, never null
+Order* FakeOrder(OrderId orderId) { return reinterpret_cast<Order*>(static_cast<std::uintptr_t>(orderId) * 64 + 64); }
+
+struct FlatIndex {
+    OrderIndex index_;
+    void Reserve(std::size_t count) { index_.Reserve(count); }
+    void Insert(OrderId orderId) { index_.Insert(orderId, FakeOrder(orderId)); }
+    Order* Find(OrderId orderId) const { return index_.Find(orderId); }
+    void Erase(OrderId orderId) { index_.Erase(orderId); }
+    std::size_t Bytes() const { return index_.MemoryBytes(); }
+};
+
+struct NodeIndex {
+    std::unordered_map<OrderId, Order*> map_;
+    void Reserve(std::size_t count) { map_.reserve(count); }
+    void Insert(OrderId orderId) { map_.emplace(orderId, FakeOrder(orderId)); }
+    Order* Find(OrderId orderId) const { auto it = map_.find(orderId); return it == map_.end() ? nullptr : it->second; }
+    void Erase(OrderId orderId) { map_.erase(orderId); }
+    // buckets plus one node per entry (next pointer, key, value) rounded to malloc's 32-byte chunk
+    std::size_t Bytes() const { return map_.bucket_count() * sizeof(void*) + map_.size() * 32; }
+};
+
+template <typename Index>
+void Run(const char* name, std::size_t live) {
+    std::mt19937_64 gen{ 5 };
+    Index index;
+    index.Reserve(live);
+
+    // live ids are a sliding set: slot i of ids holds one live id
+    std::vector<OrderId> ids(live);
+    OrderId nextId = 1;
+    auto insertNanos = TimeNanos([&] {
+        for (std::size_t i = 0; i < live; ++i) {
+            ids[i] = nextId;
+            index.Insert(nextId++);
+        }
+    });
+
+    std::vector<OrderId> probes(kOps);
+    for (auto& probe : probes) probe = ids[gen() % live];
+    std::uintptr_t sink = 0;
+    auto hitNanos = TimeNanos([&] {
+        for (OrderId probe : probes) sink += reinterpret_cast<std::uintptr_t>(index.Find(probe));
+    });
+    for (auto& probe : probes) probe = nextId + gen() % (live * 4);
+    auto missNanos = TimeNanos([&] {
+        for (OrderId probe : probes) sink += reinterpret_cast<std::uintptr_t>(index.Find(probe));
+    });
+
+    std::vector<std::size_t> victims(kOps);
+    for (auto& victim : victims) victim = gen() % live;
+    auto churnNanos = TimeNanos([&] {
+        for (std::size_t victim : victims) {
+            index.Erase(ids[victim]);
+            ids[victim] = nextId;
+            index.Insert(nextId++);
+        }
+    });
+
+    std::cout << std::setw(10) << live << std::setw(15) << name << std::fixed << std::setprecision(1)
+              << std::setw(10) << insertNanos / static_cast<double>(live)
+              << std::setw(10) << hitNanos / static_cast<double>(kOps)
+              << std::setw(10) << missNanos / static_cast<double>(kOps)
+              << std::setw(10) << churnNanos / static_cast<double>(kOps)
+              << std::setw(12) << static_cast<double>(index.Bytes()) / live
+              << (sink == 1 ? "*" : "") << "\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = { 1'000'000, 10'000'000 };
+
+    std::cout << std::setw(10) << "live" << std::setw(15) << "index" << std::setw(10) << "insert"
+              << std::setw(10) << "hit" << std::setw(10) << "miss" << std::setw(10) << "churn"
+              << std::setw(12) << "bytes/order" << "   (ns/op)\n";
+    for (std::size_t live : sizes) {
+        Run<FlatIndex>("OrderIndex", live);
+        Run<NodeIndex>("unordered_map", live);
+    }
+    return 0;
+}
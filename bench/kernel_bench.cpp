@@ -0,0 +1,125 @@
+// Add latency and instructions per add for each order type against a deep two-sided book.
+// Aggressors come as a bid/ask pair; after each pair, untimed, the book is put back: every fill
+// is re-quoted at its price and any rested remainder is cancelled, so each pair sees the same
+// depth. Build it twice to compare the specialized matching kernels with the generic path:
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/kernel_bench.cpp -o kernel_bench
+//        g++ -std=c++20 -O3 -DORDERBOOK_MATCH_KERNELS=0 -Isrc -Ibench bench/kernel_bench.cpp -o kernel_bench_generic
+// usage: kernel_bench [orders] [--dense]
+#include "orderbook.h"
+#include "LatencyStats.h"
+#include "PerfCounters.h"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+
+namespace {
+
+constexpr Price kMid = 10'000;
+constexpr std::size_t kLevels = 100;         // per side
+constexpr std::size_t kOrdersPerLevel = 5;
+constexpr Quantity kLotSize = 10;
+constexpr std::size_t kBlock = 2;   // one aggressor per side
+
+struct Scenario {
+    const char* name_;
+    OrderType type_;
+    Quantity quantity_;
+    Price through_;   // ticks past the opposite touch; negative rests behind the own touch
+};
+
+constexpr Scenario kScenarios[] = {
+    { "rest",          OrderType::GoodTillCancel, 25, -2 },
+    { "GoodTillCancel", OrderType::GoodTillCancel, 25, 2 },
+    { "GoodForDay",    OrderType::GoodForDay,     25, 2 },
+    { "FillAndKill",   OrderType::FillAndKill,    25, 2 },
+    { "FillOrKill",    OrderType::FillOrKill,     25, 2 },
+    { "Market",        OrderType::Market,         25, 0 },
+    { "sweep",         OrderType::GoodTillCancel, 180, 8 },
+};
+
+OrderBook MakeBook(bool dense, OrderId& nextId) {
+    OrderBook book = dense ? OrderBook{ LadderConfig{ kMid - 5'000, 1, 10'000 } } : OrderBook{};
+    book.ReserveOrders(2 * kLevels * kOrdersPerLevel * 2);
+    for (std::size_t level = 0; level < kLevels; ++level) {
+        for (std::size_t i = 0; i < kOrdersPerLevel; ++i) {
+            book.AddOrder(Order(nextId++, kMid - 1 - static_cast<Price>(level), kLotSize, Side::BID, OrderType::GoodTillCancel));
+            book.AddOrder(Order(nextId++, kMid + 1 + static_cast<Price>(level), kLotSize, Side::ASK, OrderType::GoodTillCancel));
+        }
+    }
+    return book;
+}
+
+void Run(const Scenario& scenario, std::size_t count, bool dense) {
+    OrderId nextId = 1;
+    OrderBook book = MakeBook(dense, nextId);
+    LatencyStats latency{ scenario.name_, count };
+    PerfCounters counters;
+    std::uint64_t instructions = 0;
+    bool instructionsAvailable = false;
+    std::vector<Order> block;
+    Trades trades;
+    std::uint64_t totalNanos = 0;
+
+    for (std::size_t done = 0; done < count; done += kBlock) {
+        block.clear();
+        for (std::size_t i = 0; i < kBlock; ++i) {
+            Side side = i % 2 ? Side::ASK : Side::BID;
+            Price price = side == Side::BID
+                ? (scenario.through_ < 0 ? book.GetBestBid().price_ : book.GetBestAsk().price_) + scenario.through_
+                : (scenario.through_ < 0 ? book.GetBestAsk().price_ : book.GetBestBid().price_) - scenario.through_;
+            block.push_back(Order(nextId++, price, scenario.quantity_, side, scenario.type_));
+        }
+
+        trades.clear();
+        counters.Start();
+        for (const Order& order : block) {
+            auto nanos = TimeNanos([&] {
+                Trades filled = book.AddOrder(order);
+                trades.insert(trades.end(), filled.begin(), filled.end());
+            });
+            latency.Record(nanos);
+            totalNanos += nanos;
+        }
+        counters.Stop();
+        counters.ForEach([&](const std::string& name, std::uint64_t value, bool available) {
+            if (name != "instructions") return;
+            instructions += value;
+            instructionsAvailable = available;
+        });
+
+        // put the book back: drop whatever rested, re-quote every resting order that was hit
+        OrderId firstId = block.front().GetOrderId();
+        for (const Order& order : block) book.CancelOrder(order.GetOrderId());
+        for (const Trade& trade : trades) {
+            if (trade.GetBidOrderId() < firstId)
+                book.AddOrder(Order(nextId++, trade.GetBidPrice(), trade.GetQuantity(), Side::BID, OrderType::GoodTillCancel));
+            else if (trade.GetAskOrderId() < firstId)
+                book.AddOrder(Order(nextId++, trade.GetAskPrice(), trade.GetQuantity(), Side::ASK, OrderType::GoodTillCancel));
+        }
+    }
+
+    std::cout << std::left << std::setw(16) << scenario.name_ << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << totalNanos / static_cast<double>(count)
+              << std::setw(8) << latency.Percentile(50)
+              << std::setw(8) << latency.Percentile(99);
+    if (instructionsAvailable) std::cout << std::setw(14) << instructions / static_cast<double>(count) << "\n";
+    else std::cout << std::setw(14) << "n/a" << "\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = 200'000;
+    bool dense = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--dense") == 0) dense = true;
+        else count = std::strtoull(argv[i], nullptr, 10);
+    }
+
+    std::cout << "match kernels " << (kMatchKernels ? "on" : "off (generic)") << ", "
+              << (dense ? "dense ladder" : "map") << " book, " << count << " adds per scenario\n"
+              << std::left << std::setw(16) << "scenario" << std::right << std::setw(10) << "mean ns"
+              << std::setw(8) << "p50" << std::setw(8) << "p99" << std::setw(14) << "instr/add" << "\n";
+    for (const Scenario& scenario : kScenarios) Run(scenario, count, dense);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Rebuild a book from the engine's L2 delta feed and check it against the engine's own book.
+// A replica joins from the first full snapshot on the outbound ring, then applies deltas; it must
+// never be crossed after a delta, at the end its full depth must equal the book's, and no sequence
+// gap may have been seen. Some adds are FillAndKill or Market, so aggressors sweep and rest.
+// build: g++ -std=c++20 -O3 -pthread -Isrc bench/l2_feed_check.cpp -o l2_feed_check
+#include "MatchingEngine.h"
+#include "LatencyStats.h"
+#include <random>
+
+namespace {
+
+constexpr std::size_t kCommands = 2'000'000;
+
+bool SameLevels(const LevelInfos& a, const LevelInfos& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        if (a[i].price_ != b[i].price_ || a[i].quantity_ != b[i].quantity_) return false;
+    return true;
+}
+
+}
+
+int main() {
+    EngineConfig config;
+    config.outboundCapacity_ = 1 << 22;
+    config.snapshotInterval_ = 500;
+    config.depthLevels_ = kMaxSnapshotDepth;
+    MatchingEngine engine{ config };
+    engine.Start();
+
+    L2Book replica;
+    L2Snapshot pending;
+    std::uint32_t pendingLevels = 0;
+    std::uint64_t deltas = 0, gaps = 0, crossed = 0;
+    std::atomic<bool> producing{true};
+
+    std::thread consumer([&] {
+        EngineEvent event;
+        while (true) {
+            if (!engine.PollEvent(event)) {
+                if (!producing.load()) break;
+                std::this_thread::yield();
+                continue;
+            }
+            switch (event.type_) {
+            case EngineEventType::SnapshotBegin:
+                pending = L2Snapshot{};
+                pending.sequence_ = event.level_.sequence_;
+                pendingLevels = event.count_;
+                if (pendingLevels == 0 && !replica.IsSynced()) replica.Reset(pending);
+                break;
+            case EngineEventType::SnapshotLevel:
+                (event.level_.side_ == Side::BID ? pending.bids_ : pending.asks_).push_back({ event.level_.price_, event.level_.quantity_ });
+                if (--pendingLevels == 0 && !replica.IsSynced()) replica.Reset(pending);
+                break;
+            case EngineEventType::LevelUpdate:
+                ++deltas;
+                if (replica.IsSynced() && !replica.Apply(event.level_)) ++gaps;
+                if (replica.IsSynced() && replica.IsCrossed()) ++crossed;
+                break;
+            default:
+                break;
+            }
+        }
+    });
+
+    std::mt19937_64 gen{ 5 };
+    std::uniform_int_distribution<Price> price(90, 110);
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+    std::vector<OrderId> live;
+    auto elapsed = TimeNanos([&] {
+        for (OrderId id = 1; id <= kCommands; ++id) {
+            if (!live.empty() && gen() % 3 == 0) {
+                std::size_t pick = gen() % live.size();
+                engine.Submit(Command::Cancel(live[pick]));
+                live[pick] = live.back();
+                live.pop_back();
+            } else {
+                Side side = gen() % 2 ? Side::BID : Side::ASK;
+                Price p = side == Side::BID ? price(gen) - 5 : price(gen) + 5;
+                auto pick = gen() % 20;
+                OrderType type = pick == 0 ? OrderType::FillAndKill : pick == 1 ? OrderType::Market : OrderType::GoodTillCancel;
+                engine.Submit(Command::Add(Order(id, p, qty(gen), side, type)));
+                live.push_back(id);
+            }
+        }
+        while (engine.GetStats().commandsProcessed_ < kCommands) std::this_thread::yield();
+    });
+    engine.Stop();
+    producing = false;
+    consumer.join();
+
+    auto snapshot = engine.GetSnapshot();
+    auto stats = engine.GetStats();
+    bool match = replica.IsSynced()
+        && replica.GetSequence() == snapshot.sequence_
+        && SameLevels(replica.GetBids(kMaxSnapshotDepth), snapshot.GetBids(kMaxSnapshotDepth))
+        && SameLevels(replica.GetAsks(kMaxSnapshotDepth), snapshot.GetAsks(kMaxSnapshotDepth));
+
+    std::cout << "commands=" << kCommands << " deltas=" << deltas << " gaps=" << gaps << " crossed=" << crossed
+              << " dropped=" << stats.eventsDropped_ << " seq=" << snapshot.sequence_
+              << " cmd/s=" << kCommands * 1e9 / elapsed << "\n"
+              << (match ? "replica matches engine book\n" : "MISMATCH between replica and engine book\n")
+              << (crossed ? "replica was CROSSED after a delta\n" : "");
+    return match && gaps == 0 && crossed == 0 ? 0 : 1;
+}
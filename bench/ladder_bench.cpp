@@ -0,0 +1,74 @@
+// Add/cancel/match latency of the map-based book against the dense price ladder.
+// build: g++ -std=c++20 -O3 -Isrc bench/ladder_bench.cpp -o ladder_bench
+#include "orderbook.h"
+#include "LatencyStats.h"
+#include <random>
+
+namespace {
+
+constexpr Price kMid = 10000;
+constexpr Price kSpread = 500;
+constexpr std::size_t kRestingOrders = 200000;
+constexpr std::size_t kAggressiveOrders = 50000;
+
+void RunScenario(const std::string& name, OrderBook& book) {
+    std::mt19937_64 gen{ 42 };
+    std::uniform_int_distribution<Price> offset(1, kSpread);
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+    std::bernoulli_distribution isBid(0.5);
+
+    LatencyStats adds{ name + " add", kRestingOrders };
+    LatencyStats cancels{ name + " cancel", kRestingOrders / 2 };
+    LatencyStats matches{ name + " match", kAggressiveOrders };
+
+    OrderId nextId = 1;
+    std::vector<OrderId> live;
+    live.reserve(kRestingOrders);
+
+    // Resting liquidity on both sides of the mid, never crossing
+    for (std::size_t i = 0; i < kRestingOrders; ++i) {
+        Side side = isBid(gen) ? Side::BID : Side::ASK;
+        Price price = side == Side::BID ? kMid - offset(gen) : kMid + offset(gen);
+        Order order(nextId, price, qty(gen), side, OrderType::GoodTillCancel);
+        live.push_back(nextId++);
+        adds.Record(TimeNanos([&] { book.AddOrder(order); }));
+    }
+
+    // Pull half of it in random order
+    std::shuffle(live.begin(), live.end(), gen);
+    for (std::size_t i = 0; i < live.size() / 2; ++i) {
+        OrderId id = live[i];
+        cancels.Record(TimeNanos([&] { book.CancelOrder(id); }));
+    }
+
+    // Aggressors that reach a few levels through the touch
+    std::uniform_int_distribution<Price> reach(0, 3);
+    for (std::size_t i = 0; i < kAggressiveOrders; ++i) {
+        Side side = isBid(gen) ? Side::BID : Side::ASK;
+        auto touch = side == Side::BID ? book.GetAsks(1) : book.GetBids(1);
+        if (touch.empty()) break;
+        Price price = side == Side::BID ? touch[0].price_ + reach(gen) : touch[0].price_ - reach(gen);
+        Order order(nextId++, price, qty(gen) * 4, side, OrderType::FillAndKill);
+        matches.Record(TimeNanos([&] { book.AddOrder(order); }));
+
+        // Replenish the side that was hit so the book does not drain
+        Side passive = side == Side::BID ? Side::ASK : Side::BID;
+        Price restPrice = passive == Side::BID ? kMid - offset(gen) : kMid + offset(gen);
+        book.AddOrder(Order(nextId++, restPrice, qty(gen) * 4, passive, OrderType::GoodTillCancel));
+    }
+
+    adds.Print();
+    cancels.Print();
+    matches.Print();
+}
+
+}
+
+int main() {
+    OrderBook mapBook;
+    RunScenario("map", mapBook);
+
+    OrderBook ladderBook{ LadderConfig{ kMid - 4096, 1, 8192 } };
+    RunScenario("ladder", ladderBook);
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Cost of getting fills out of the book: a Trades vector returned per command (ApplyCommand),
+// one Trades buffer reused across commands (Apply(command, trades)), and a listener the book
+// calls directly (BasicOrderBook<Listener>::Apply(command)). Allocations are counted with the
+// replaced global operator new of CountingNew.h, after the book has been built and reserved.
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/listener_bench.cpp -o listener_bench
+// usage: listener_bench [commands] [seed]
+#include "orderbook.h"
+#include "CountingNew.h"
+#include "LatencyStats.h"
+#include "QuoteFlow.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr int kRounds = 5;
+
+struct CountingListener {
+    std::size_t accepts_{0};
+    std::size_t fills_{0};
+    std::size_t cancels_{0};
+    std::size_t rejects_{0};
+    std::uint64_t filledQuantity_{0};
+
+    void OnAccept(const OrderEvent&) { ++accepts_; }
+    void OnPartialFill(const OrderEvent& event) { ++fills_; filledQuantity_ += event.quantity_; }
+    void OnFill(const OrderEvent& event) { ++fills_; filledQuantity_ += event.quantity_; }
+    void OnCancel(const OrderEvent&) { ++cancels_; }
+    void OnReject(const OrderEvent&, RejectReason) { ++rejects_; }
+};
+
+struct Result {
+    double nanos_{1e18};
+    std::size_t allocations_{0};
+    std::uint64_t quantity_{0};   // both sides of every fill
+};
+
+template <typename Book, typename F>
+void Measure(const std::vector<Command>& commands, Result& result, F&& run) {
+    Book book = MakeQuoteBook<Book>();
+    std::uint64_t quantity = 0;
+    std::uint64_t before = heapAllocations.load();
+    auto elapsed = TimeNanos([&] { quantity = run(book); });
+    result.allocations_ = heapAllocations.load() - before;
+    result.nanos_ = std::min(result.nanos_, static_cast<double>(elapsed) / commands.size());
+    result.quantity_ = quantity;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 7;
+    std::vector<Command> commands = MakeQuoteFlow(count, seed);
+
+    Result vector, buffer, listener;
+    std::size_t events = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        Measure<OrderBook>(commands, vector, [&](OrderBook& book) {
+            std::uint64_t quantity = 0;
+            for (const auto& command : commands)
+                for (const auto& trade : ApplyCommand(book, command)) quantity += 2 * trade.GetQuantity();
+            return quantity;
+        });
+        Measure<OrderBook>(commands, buffer, [&](OrderBook& book) {
+            std::uint64_t quantity = 0;
+            Trades trades;
+            for (const auto& command : commands) {
+                trades.clear();
+                book.Apply(command, trades);
+                for (const auto& trade : trades) quantity += 2 * trade.GetQuantity();
+            }
+            return quantity;
+        });
+        Measure<BasicOrderBook<CountingListener>>(commands, listener, [&](BasicOrderBook<CountingListener>& book) {
+            for (const auto& command : commands) book.Apply(command);
+            const auto& counts = book.GetListener();
+            events = counts.accepts_ + counts.fills_ + counts.cancels_ + counts.rejects_;
+            return counts.filledQuantity_;
+        });
+    }
+
+    if (buffer.quantity_ != vector.quantity_ || listener.quantity_ != vector.quantity_) {
+        std::cerr << "filled quantity differs: vector " << vector.quantity_ << ", buffer " << buffer.quantity_
+                  << ", listener " << listener.quantity_ << "\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "commands: " << count << ", listener events: " << events << ", best of " << kRounds << "\n"
+              << std::setw(10) << "path" << std::setw(10) << "ns/cmd" << std::setw(14) << "allocs/cmd" << "\n";
+    auto print = [&](const char* name, const Result& result) {
+        std::cout << std::setw(10) << name << std::setw(10) << result.nanos_
+                  << std::setw(14) << std::setprecision(4) << static_cast<double>(result.allocations_) / count
+                  << std::setprecision(2) << "\n";
+    };
+    print("vector", vector);
+    print("buffer", buffer);
+    print("listener", listener);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Pulling quotes in bulk: cancels [orders] resting orders with one mass cancel and with a
+// CancelOrder per order, on a map book and a dense ladder. The orders sit [per level] to a level
+// on the bid side; the owner case interleaves them with as many orders of another owner that
+// stay. Reports time per order cancelled and the level deltas each way emits.
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/mass_cancel_bench.cpp -o mass_cancel_bench
+// usage: mass_cancel_bench [orders] [per level]    (default 100k, 100)
+#include "orderbook.h"
+#include "LatencyStats.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+constexpr Price kTopBid = 100'000;
+constexpr Owner kQuoter = 7;
+constexpr Owner kOther = 8;
+constexpr int kRounds = 3;
+
+enum class Case
+{
+	Side,
+	Range,
+	Owner
+};
+
+struct Result {
+    double loopNanos_{1e18};   // per order cancelled
+    double massNanos_{1e18};
+    std::size_t loopDeltas_{0};
+    std::size_t massDeltas_{0};
+};
+
+// The orders to cancel, bids below kTopBid, plus an ask so the book is two-sided. The owner case
+// puts another owner's order after each of them; the range case leaves a tenth of the levels
+// below the band in place.
+OrderBook MakeBook(bool dense, Case what, std::size_t orders, std::size_t perLevel, std::vector<OrderId>& ids) {
+    std::size_t levels = (orders + perLevel - 1) / perLevel;
+    OrderBook book = dense ? OrderBook{ LadderConfig{ kTopBid - 2 * static_cast<Price>(levels), 1, 2 * levels + 2 } } : OrderBook{};
+    book.ReserveOrders(2 * orders + 1);
+    ids.clear();
+    OrderId nextId = 1;
+    book.Add(Order(nextId++, kTopBid + 1, 100, Side::ASK, OrderType::GoodTillCancel));
+    for (std::size_t i = 0; i < orders; ++i) {
+        Price price = kTopBid - static_cast<Price>(i / perLevel);
+        ids.push_back(nextId);
+        book.Add(Order(nextId++, price, 10, Side::BID, OrderType::GoodTillCancel, 0, kQuoter));
+        if (what == Case::Owner) book.Add(Order(nextId++, price, 10, Side::BID, OrderType::GoodTillCancel, 0, kOther));
+    }
+    if (what == Case::Range) {
+        for (std::size_t level = 0; level < std::max<std::size_t>(1, levels / 10); ++level)
+            book.Add(Order(nextId++, kTopBid - static_cast<Price>(levels + level), 10, Side::BID, OrderType::GoodTillCancel));
+    }
+    return book;
+}
+
+Result Measure(bool dense, Case what, std::size_t orders, std::size_t perLevel) {
+    Result result;
+    std::vector<OrderId> ids;
+    LevelUpdates deltas;
+    for (int round = 0; round < kRounds; ++round) {
+        OrderBook looped = MakeBook(dense, what, orders, perLevel, ids);
+        deltas.clear();
+        looped.SetLevelUpdateSink(&deltas);
+        auto loop = TimeNanos([&] { for (OrderId id : ids) looped.CancelOrder(id); });
+        result.loopDeltas_ = deltas.size();
+
+        OrderBook mass = MakeBook(dense, what, orders, perLevel, ids);
+        deltas.clear();
+        mass.SetLevelUpdateSink(&deltas);
+        std::size_t cancelled = 0;
+        auto bulk = TimeNanos([&] {
+            if (what == Case::Side) cancelled = mass.CancelSide(Side::BID);
+            else if (what == Case::Range) cancelled = mass.CancelRange(Side::BID, kTopBid - static_cast<Price>((orders - 1) / perLevel), kTopBid);
+            else cancelled = mass.CancelOwner(kQuoter);
+        });
+        result.massDeltas_ = deltas.size();
+
+        if (cancelled != ids.size() || mass.Size() != looped.Size() || mass.GetBestBid().price_ != looped.GetBestBid().price_) {
+            std::cerr << "mass cancel disagrees with the loop: " << cancelled << " of " << ids.size() << " cancelled\n";
+            std::exit(1);
+        }
+        result.loopNanos_ = std::min(result.loopNanos_, static_cast<double>(loop) / ids.size());
+        result.massNanos_ = std::min(result.massNanos_, static_cast<double>(bulk) / ids.size());
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t orders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+    std::size_t perLevel = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+    if (orders == 0 || perLevel == 0) {
+        std::cerr << "usage: mass_cancel_bench [orders] [per level]\n";
+        return 2;
+    }
+
+    std::cout << orders << " orders cancelled, " << perLevel << " per level, best of " << kRounds << "\n"
+              << std::fixed << std::setprecision(1);
+    for (bool dense : { false, true }) {
+        for (Case what : { Case::Side, Case::Range, Case::Owner }) {
+            Result result = Measure(dense, what, orders, perLevel);
+            const char* name = what == Case::Side ? "side " : what == Case::Range ? "range" : "owner";
+            std::cout << (dense ? "dense " : "map   ") << name
+                      << "  per-order: " << std::setw(6) << result.loopNanos_ << " ns/order, " << std::setw(7) << result.loopDeltas_ << " deltas"
+                      << "  mass: " << std::setw(6) << result.massNanos_ << " ns/order, " << std::setw(7) << result.massDeltas_ << " deltas"
+                      << "  (" << result.loopNanos_ / result.massNanos_ << "x)\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Memory footprint and cache behaviour of a book holding N resting orders: resident bytes per
+// order (total, and the part that is pool slots) and L1D/LLC read misses per operation while
+// building the book and under steady cancel/replace churn. Each size runs in its own process so
+// resident memory is measured from a clean heap.
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/memory_bench.cpp -o memory_bench
+// usage: memory_bench [orders...]        (default 1000000 10000000 50000000)
+// Miss counts need perf_event access (perf_event_paranoid <= 2 and a PMU); they print n/a otherwise.
+#include "orderbook.h"
+#include "PerfCounters.h"
+#include "LatencyStats.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr Price kMid = 100'000;
+constexpr Price kDepth = 10'000;            // ticks per side
+constexpr std::size_t kChurnOps = 1'000'000;
+
+std::size_t ResidentBytes() {
+    std::size_t pages = 0, resident = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(statm, "%zu %zu", &pages, &resident) != 2) resident = 0;
+        std::fclose(statm);
+    }
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void PrintCounters(const char* phase, const PerfCounters& counters, std::size_t ops) {
+    std::cout << "  " << std::left << std::setw(8) << phase << std::right;
+    counters.ForEach([&](const std::string& name, std::uint64_t value, bool available) {
+        std::cout << "  " << name << "/op=";
+        if (available) std::cout << std::fixed << std::setprecision(2) << static_cast<double>(value) / ops;
+        else std::cout << "n/a";
+    });
+    std::cout << "\n";
+}
+
+void Measure(std::size_t orders) {
+    std::mt19937_64 gen{ orders };
+    std::uniform_int_distribution<Price> ticks(1, kDepth);
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+    auto randomOrder = [&](OrderId id) {
+        Side side = id % 2 ? Side::BID : Side::ASK;
+        return Order(id, side == Side::BID ? kMid - ticks(gen) : kMid + ticks(gen), qty(gen), side, OrderType::GoodTillCancel);
+    };
+
+    std::vector<std::uint64_t> live((orders + kChurnOps + 64) / 64 + 1);   // liveness bitmap by id
+    auto isLive = [&](OrderId id) { return (live[id / 64] >> (id % 64)) & 1; };
+    auto setLive = [&](OrderId id, bool on) {
+        if (on) live[id / 64] |= std::uint64_t{ 1 } << (id % 64);
+        else live[id / 64] &= ~(std::uint64_t{ 1 } << (id % 64));
+    };
+
+    std::size_t before = ResidentBytes();
+    OrderBook book{ LadderConfig{ kMid - kDepth, 1, static_cast<std::size_t>(2 * kDepth + 1) } };
+    book.ReserveOrders(orders);
+
+    PerfCounters counters;
+    OrderId nextId = 1;
+    counters.Start();
+    auto buildNanos = TimeNanos([&] {
+        for (std::size_t i = 0; i < orders; ++i) {
+            book.AddOrder(randomOrder(nextId));
+            setLive(nextId++, true);
+        }
+    });
+    counters.Stop();
+    std::size_t resident = ResidentBytes() - before;
+
+    std::cout << orders << " resting orders: " << std::fixed << std::setprecision(1)
+              << static_cast<double>(resident) / orders << " bytes/order resident, "
+              << static_cast<double>(book.GetOrderPool().Capacity() * OrderPool::SlotSize()) / orders << " of it pool slots (sizeof(Order) = "
+              << sizeof(Order) << "), build " << buildNanos / static_cast<double>(orders) << " ns/order\n";
+    PrintCounters("build", counters, orders);
+
+    // Steady state: cancel a random live order, add a fresh one, so the book stays at N
+    counters.Start();
+    auto churnNanos = TimeNanos([&] {
+        for (std::size_t i = 0; i < kChurnOps; ++i) {
+            OrderId victim;
+            do victim = 1 + gen() % (nextId - 1); while (!isLive(victim));
+            book.CancelOrder(victim);
+            setLive(victim, false);
+            book.AddOrder(randomOrder(nextId));
+            setLive(nextId++, true);
+        }
+    });
+    counters.Stop();
+    std::cout << "  churn    " << std::setprecision(1) << churnNanos / static_cast<double>(kChurnOps) << " ns per cancel+add\n";
+    PrintCounters("churn", counters, kChurnOps);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = { 1'000'000, 10'000'000, 50'000'000 };
+
+    int failures = 0;
+    for (std::size_t orders : sizes) {
+        std::cout.flush();
+        pid_t child = fork();
+        if (child == 0) {
+            Measure(orders);
+            std::cout.flush();
+            std::_Exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cout << orders << " resting orders: failed (status " << status << ", out of memory?)\n";
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// Cost of hot-path instrumentation: engine throughput with and without a MetricsRegistry attached,
+// then the stats dump read back through the JSON file and the Unix socket. Build a second binary
+// with -DORDERBOOK_METRICS=0 to compare against the recording calls compiled out entirely.
+// build: g++ -std=c++20 -O3 -pthread -Isrc -Ibench bench/metrics_bench.cpp -o metrics_bench
+// usage: metrics_bench [commands]
+#include "MatchingEngine.h"
+#include "StatsEndpoint.h"
+#include "LatencyStats.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace {
+
+constexpr const char* kStatsFile = "/tmp/orderbook-metrics-bench.json";
+constexpr const char* kStatsSocket = "/tmp/orderbook-metrics-bench.sock";
+
+std::vector<Command> MakeFlow(std::size_t count) {
+    std::mt19937_64 gen{ 3 };
+    std::vector<Command> commands;
+    commands.reserve(count);
+    std::vector<OrderId> live;
+    for (OrderId id = 1; commands.size() < count; ++id) {
+        auto roll = gen() % 100;
+        if (roll < 30 && !live.empty()) {
+            std::size_t pick = gen() % live.size();
+            commands.push_back(Command::Cancel(live[pick]));
+            live[pick] = live.back();
+            live.pop_back();
+            continue;
+        }
+        Side side = gen() % 2 ? Side::BID : Side::ASK;
+        Price price = side == Side::BID ? 990 + static_cast<Price>(gen() % 12) : 999 + static_cast<Price>(gen() % 12);
+        commands.push_back(Command::Add(Order(id, price, 1 + static_cast<Quantity>(gen() % 100), side, OrderType::GoodTillCancel)));
+        live.push_back(id);
+    }
+    return commands;
+}
+
+// Commands per second through a started engine, consuming its outbound ring as it goes
+double Throughput(const std::vector<Command>& commands, MetricsRegistry* metrics) {
+    EngineConfig config;
+    config.outboundCapacity_ = 1 << 20;
+    MatchingEngine engine{ config };
+    engine.SetMetrics(metrics);
+    engine.Start();
+    std::atomic<bool> done{false};
+    std::thread consumer([&] {
+        EngineEvent event;
+        while (!done.load()) while (engine.PollEvent(event)) { }
+    });
+    auto nanos = TimeNanos([&] {
+        for (const auto& command : commands) engine.Submit(command);
+        while (engine.GetStats().commandsProcessed_ < commands.size()) std::this_thread::yield();
+    });
+    engine.Stop();
+    done.store(true);
+    consumer.join();
+    return commands.size() * 1e9 / nanos;
+}
+
+std::string ReadSocket(const char* path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path);
+    std::string out;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        char buffer[4096];
+        for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) out.append(buffer, static_cast<std::size_t>(n));
+    }
+    close(fd);
+    return out;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    std::vector<Command> commands = MakeFlow(count);
+
+    // alternate so machine drift hits both alike; best of three each
+    double bare = 0, instrumented = 0;
+    MetricsRegistry metrics;
+    for (int round = 0; round < 3; ++round) {
+        bare = std::max(bare, Throughput(commands, nullptr));
+        MetricsRegistry roundMetrics;
+        instrumented = std::max(instrumented, Throughput(commands, round == 2 ? &metrics : &roundMetrics));
+    }
+    std::cout << "ORDERBOOK_METRICS=" << ORDERBOOK_METRICS << "\n"
+              << "no registry:   " << static_cast<std::uint64_t>(bare) << " cmd/s\n"
+              << "with registry: " << static_cast<std::uint64_t>(instrumented) << " cmd/s ("
+              << (instrumented / bare - 1) * 100 << "%)\n\n";
+
+    StatsEndpoint endpoint{ metrics, StatsConfig{ kStatsFile, kStatsSocket, std::chrono::milliseconds{ 100 } } };
+    endpoint.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    std::string fromSocket = ReadSocket(kStatsSocket);
+    endpoint.Stop();
+    std::stringstream fromFile;
+    fromFile << std::ifstream{ kStatsFile }.rdbuf();
+
+    std::cout << metrics.ToText() << "\nsocket dump: " << fromSocket.size() << " bytes, file dump: " << fromFile.str().size() << " bytes\n";
+    std::remove(kStatsFile);
+    bool ok = !fromSocket.empty() && fromSocket.front() == '{' && !fromFile.str().empty();
+    return ok ? 0 : 1;
+}
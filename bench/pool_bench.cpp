@@ -0,0 +1,65 @@
+// Heap allocations per million orders once the book has reached steady state.
+// The pool figure must read zero; the process-wide figure shows what the rest of the book
+// still allocates (order index nodes, returned Trades vectors).
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/pool_bench.cpp -o pool_bench
+#include "orderbook.h"
+#include "CountingNew.h"
+#include "LatencyStats.h"
+#include <random>
+
+namespace {
+
+constexpr std::size_t kWarmupOrders = 1'000'000;
+constexpr std::size_t kMeasuredOrders = 10'000'000;
+constexpr std::size_t kTargetDepth = 100'000;
+
+}
+
+int main() {
+    OrderBook book;
+    book.ReserveOrders(kTargetDepth * 2);
+    std::mt19937_64 gen{ 11 };
+    std::uniform_int_distribution<Price> price(90, 110);
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+
+    std::vector<OrderId> live;
+    live.reserve(kTargetDepth * 2);
+    OrderId nextId = 1;
+
+    // Resting adds on both sides plus random cancels and the occasional crossing order
+    auto step = [&] {
+        if (live.size() > kTargetDepth && gen() % 2 == 0) {
+            std::size_t pick = gen() % live.size();
+            book.CancelOrder(live[pick]);
+            live[pick] = live.back();
+            live.pop_back();
+            return;
+        }
+        Side side = gen() % 2 ? Side::BID : Side::ASK;
+        Price p = side == Side::BID ? price(gen) - 11 : price(gen) + 11;
+        if (gen() % 16 == 0) p = side == Side::BID ? 130 : 70;
+        book.AddOrder(Order(nextId, p, qty(gen), side, OrderType::GoodTillCancel));
+        live.push_back(nextId++);
+    };
+
+    for (std::size_t i = 0; i < kWarmupOrders; ++i) step();
+
+    book.GetOrderPool().ResetCounters();
+    std::uint64_t heapBefore = heapAllocations.load();
+    OrderId firstMeasured = nextId;
+
+    auto elapsed = TimeNanos([&] {
+        for (std::size_t i = 0; i < kMeasuredOrders; ++i) step();
+    });
+
+    double orders = static_cast<double>(nextId - firstMeasured);
+    double heapPerMillion = (heapAllocations.load() - heapBefore) * 1e6 / orders;
+
+    std::cout << "orders added:                  " << static_cast<std::uint64_t>(orders) << "\n"
+              << "pool allocations / 1M orders:  " << book.GetOrderPool().AllocationsPerMillionOrders() << "\n"
+              << "heap allocations / 1M orders:  " << heapPerMillion << "\n"
+              << "live orders / pool capacity:   " << book.GetOrderPool().Live() << " / " << book.GetOrderPool().Capacity() << "\n"
+              << "ops/sec:                       " << kMeasuredOrders * 1e9 / elapsed << "\n";
+
+    return book.GetOrderPool().HeapAllocations() == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+// Recovery time for a book with many resting orders: journal N adds, checkpoint, journal a tail of
+// mixed traffic, then rebuild from checkpoint + tail and check the result against the live book.
+// build: g++ -std=c++20 -O3 -pthread -Isrc bench/recovery_bench.cpp -o recovery_bench
+// usage: recovery_bench [resting orders] [tail commands] [directory]
+#include "Journal.h"
+#include "LatencyStats.h"
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+bool SameBook(const OrderBook& a, const OrderBook& b) {
+    if (a.Size() != b.Size() || a.GetSequence() != b.GetSequence()) return false;
+    std::vector<std::tuple<OrderId, Price, Quantity, Quantity>> left, right;
+    left.reserve(a.Size());
+    right.reserve(b.Size());
+    a.ForEachOrder([&](const Order& o) { left.emplace_back(o.GetOrderId(), o.GetPrice(), o.GetInitialQuantity(), o.GetRemainingQuantity()); });
+    b.ForEachOrder([&](const Order& o) { right.emplace_back(o.GetOrderId(), o.GetPrice(), o.GetInitialQuantity(), o.GetRemainingQuantity()); });
+    return left == right;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t resting = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5'000'000;
+    std::size_t tail = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+    std::string directory = argc > 3 ? argv[3] : "/tmp/orderbook-recovery";
+    std::filesystem::remove_all(directory);
+
+    SymbolBooks live;
+    live.emplace_back(0, OrderBook{});
+    OrderBook& book = live.back().second;
+    book.ReserveOrders(resting + tail);
+
+    std::mt19937_64 gen{ 9 };
+    std::uniform_int_distribution<Price> offset(0, 5000);
+    std::uniform_int_distribution<Quantity> qty(1, 100);
+    LatencyStats append{ "journal append", resting + tail };
+    std::uint64_t checkpointNanos = 0;
+
+    {
+        Journal journal{ JournalConfig{ directory } };
+        auto submit = [&](const Command& command) {
+            auto start = std::chrono::steady_clock::now();
+            journal.Append(command);
+            append.Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+            try { ApplyCommand(book, command); } catch (const std::exception&) { }
+        };
+
+        // resting book: bids below 10000, asks above, nothing crosses
+        OrderId id = 1;
+        for (; id <= resting; ++id) {
+            Side side = id % 2 ? Side::BID : Side::ASK;
+            Price price = side == Side::BID ? 10000 - offset(gen) : 10001 + offset(gen);
+            submit(Command::Add(Order(id, price, qty(gen), side, OrderType::GoodTillCancel)));
+        }
+
+        checkpointNanos = TimeNanos([&] {
+            WriteCheckpoint(directory, journal.GetSequence(), SymbolBookRefs{ { 0, &book } });
+            journal.ReleaseBefore(journal.GetSequence() + 1);
+        });
+
+        // tail: cancels, modifies and adds, some of which cross and trade
+        for (std::size_t i = 0; i < tail; ++i) {
+            std::uint64_t roll = gen() % 10;
+            OrderId target = gen() % id + 1;
+            if (roll < 3) {
+                submit(Command::Cancel(target));
+            } else if (roll < 4) {
+                submit(Command::Modify(target, 10000 - offset(gen), qty(gen), Side::BID));
+            } else {
+                Side side = gen() % 2 ? Side::BID : Side::ASK;
+                Price price = side == Side::BID ? 9990 - offset(gen) + 20 : 10011 + offset(gen) - 20;
+                submit(Command::Add(Order(id++, price, qty(gen), side, OrderType::GoodTillCancel)));
+            }
+        }
+        journal.WaitDurable(journal.GetSequence());
+    }
+
+    SymbolBooks recovered;
+    recovered.emplace_back(0, OrderBook{});
+    RecoveryResult result;
+    auto recoveryNanos = TimeNanos([&] { result = Recover(directory, recovered); });
+    bool match = recovered.size() == 1 && SameBook(book, recovered.front().second);
+
+    append.Print();
+    std::cout << std::fixed << std::setprecision(3)
+              << "resting=" << book.Size() << " checkpoint write=" << checkpointNanos / 1e9 << "s\n"
+              << "recovery=" << recoveryNanos / 1e9 << "s restored=" << result.restoredOrders_
+              << " replayed=" << result.replayed_ << " sequence=" << result.sequence_ << "\n"
+              << (match ? "recovered book matches live book\n" : "MISMATCH between recovered and live book\n");
+    std::filesystem::remove_all(directory);
+    return match ? 0 : 1;
+}
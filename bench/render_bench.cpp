@@ -0,0 +1,178 @@
+// Order throughput of the demo with its display off, with the snapshot renderer and with the old
+// console display: a global mutex held for a full clear-and-redraw every 100ms, one locked print
+// per trade and one per hundred orders. Two producers submit as fast as the engine takes commands
+// and a market-data thread drains the outbound ring, as in main.cpp. Output goes to [sink]
+// (/dev/null by default; pass /dev/tty to see it, which makes the old display slower still).
+// build: g++ -std=c++20 -O3 -pthread -Isrc -Ibench bench/render_bench.cpp -o render_bench
+// usage: render_bench [seconds per mode] [sink]    (default 3, /dev/null)
+#include "MatchingEngine.h"
+#include "TerminalRenderer.h"
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+constexpr int kProducers = 2;
+constexpr std::size_t kDepth = 5;
+constexpr auto kFrame = std::chrono::milliseconds(100);
+
+enum class Display
+{
+	Off,
+	Renderer,
+	Legacy
+};
+
+struct RunResult {
+    double commandsPerSecond_{0};
+    std::uint64_t trades_{0};
+    std::uint64_t frames_{0};
+    std::uint64_t bytes_{0};
+    std::uint64_t droppedTrades_{0};
+};
+
+// Adds around a mid of 100 on both sides, a fifth of them crossing, so trades keep the book shallow
+Order NextOrder(std::mt19937_64& gen, OrderId id) {
+    Side side = gen() % 2 ? Side::BID : Side::ASK;
+    Price offset = static_cast<Price>(gen() % 20) + 1;
+    if (gen() % 5 == 0) offset = -2;
+    Price price = side == Side::BID ? 100 - offset : 100 + offset;
+    return Order(id, price, static_cast<Quantity>(gen() % 100) + 1, side, OrderType::GoodTillCancel);
+}
+
+// The display this replaced, kept here only for comparison
+struct LegacyConsole {
+    std::mutex mutex_;
+    std::ofstream out_;
+
+    void Frame(const MatchingEngine& engine) {
+        using namespace TerminalColors;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto snapshot = engine.GetSnapshot();
+        out_ << CLEAR_SCREEN;
+        out_ << BOLD << "╔════════════════════════════════╗" << RESET << "\n";
+        out_ << BOLD << "║         ORDER BOOK             ║" << RESET << "\n";
+        out_ << BOLD << "╠════════════════════════════════╣" << RESET << "\n";
+        out_ << RED << "║ SELLS:                         ║" << RESET << "\n";
+        for (const auto& level : snapshot.GetAsks(kDepth))
+            out_ << RED << "║ " << std::setw(8) << level.price_ << " | " << std::setw(8) << level.quantity_ << "        ║" << RESET << "\n";
+        out_ << BOLD << "╠════════════════════════════════╣" << RESET << "\n";
+        out_ << GREEN << "║ BUYS:                          ║" << RESET << "\n";
+        for (const auto& level : snapshot.GetBids(kDepth))
+            out_ << GREEN << "║ " << std::setw(8) << level.price_ << " | " << std::setw(8) << level.quantity_ << "        ║" << RESET << "\n";
+        out_ << BOLD << "╚════════════════════════════════╝" << RESET << std::endl;
+    }
+
+    void Print(const Trade& trade) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out_ << TerminalColors::BOLD << "TRADE: " << TerminalColors::RESET << "Price: " << trade.GetPrice()
+             << " Quantity: " << trade.GetQuantity() << "\n";
+    }
+
+    void Print(const Order& order) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out_ << "\nNew " << (order.GetSide() == Side::BID ? "BUY" : "SELL") << " Order: Price=" << order.GetPrice()
+             << " Qty=" << order.GetInitialQuantity() << "\n";
+    }
+};
+
+RunResult Run(Display display, double seconds, const char* sink) {
+    MatchingEngine engine;
+    engine.Start();
+    std::atomic<bool> running{true};
+    std::atomic<std::uint64_t> trades{0};
+    TradeTape tape;
+    LegacyConsole legacy;
+    if (display == Display::Legacy) legacy.out_.open(sink);
+    int fd = display == Display::Renderer ? ::open(sink, O_WRONLY) : -1;
+    if (display == Display::Renderer && fd < 0) throw std::system_error(errno, std::generic_category(), sink);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            std::mt19937_64 gen{ static_cast<std::uint64_t>(p) + 1 };
+            OrderId id = static_cast<OrderId>(p) << 40;
+            while (running.load(std::memory_order_relaxed)) {
+                Order order = NextOrder(gen, ++id);
+                if (!engine.Submit(Command::Add(order))) continue;
+                if (display == Display::Legacy && gen() % 100 == 0) legacy.Print(order);
+            }
+        });
+    }
+    std::thread marketData([&] {
+        EngineEvent event;
+        while (running.load(std::memory_order_relaxed)) {
+            bool any = false;
+            while (engine.PollEvent(event)) {
+                any = true;
+                if (event.type_ != EngineEventType::Trade) continue;
+                trades.fetch_add(1, std::memory_order_relaxed);
+                if (display == Display::Legacy) legacy.Print(event.trade_);
+                else if (display == Display::Renderer) tape.Push(event.trade_);
+            }
+            if (!any) std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    RunResult result;
+    auto started = std::chrono::steady_clock::now();
+    auto deadline = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    {
+        TerminalRenderer renderer{ fd };
+        std::vector<std::string> rows;
+        TradeSummary summary;
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (display == Display::Renderer) {
+                tape.Drain([&](const Trade& trade) { summary.Add(trade); });
+                rows.clear();
+                AppendBookRows(rows, engine.GetSnapshot(), kDepth);
+                AppendTradeRows(rows, summary, tape.Dropped());
+                renderer.Render(rows);
+            } else if (display == Display::Legacy) {
+                legacy.Frame(engine);
+            }
+            std::this_thread::sleep_for(kFrame);
+        }
+        result.frames_ = renderer.FramesWritten();
+        result.bytes_ = renderer.BytesWritten();
+    }
+    std::uint64_t processed = engine.GetStats().commandsProcessed_;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    running = false;
+    for (auto& producer : producers) producer.join();
+    engine.Stop();
+    marketData.join();
+    if (fd >= 0) ::close(fd);
+
+    result.commandsPerSecond_ = processed / elapsed;
+    result.trades_ = trades.load();
+    result.droppedTrades_ = tape.Dropped();
+    return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 3.0;
+    const char* sink = argc > 2 ? argv[2] : "/dev/null";
+
+    RunResult off = Run(Display::Off, seconds, sink);
+    RunResult renderer = Run(Display::Renderer, seconds, sink);
+    RunResult legacy = Run(Display::Legacy, seconds, sink);
+
+    auto relative = [&](const RunResult& run) { return 100.0 * run.commandsPerSecond_ / off.commandsPerSecond_; };
+    std::cout << std::fixed << std::setprecision(0)
+              << "display off:      " << off.commandsPerSecond_ << " commands/s, " << off.trades_ << " trades\n"
+              << "renderer:         " << renderer.commandsPerSecond_ << " commands/s (" << relative(renderer) << "% of off), "
+              << renderer.frames_ << " frames, " << (renderer.frames_ ? renderer.bytes_ / renderer.frames_ : 0)
+              << " bytes/frame, " << renderer.droppedTrades_ << " of " << renderer.trades_ << " trades not shown\n"
+              << "legacy console:   " << legacy.commandsPerSecond_ << " commands/s (" << relative(legacy) << "% of off)\n";
+    return 0;
+}
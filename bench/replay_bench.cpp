@@ -0,0 +1,392 @@
+// Deterministic order-flow replay: runs a seeded synthetic scenario, or a recorded journal, through
+// OrderBook at full speed and reports throughput plus p50/p99/p99.9/max latency per operation
+// (passive add, matching add, cancel, modify). The same seed always produces the same stream, so
+// numbers are comparable between commits; --json writes them in a form regressions can be diffed on.
+// build: g++ -std=c++20 -O3 -pthread -Isrc -Ibench bench/replay_bench.cpp -o replay_bench
+// usage: replay_bench [--scenario deep_book|cancel_heavy|sweep|immediate|amend|all] [--seed N] [--commands N]
+//                     [--journal dir] [--record dir] [--json file|-] [--label text]
+#include "HdrHistogram.h"
+#include "Journal.h"
+#include "LatencyStats.h"
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+constexpr Price kMid = 10000;
+
+// One seeded order stream: prefill_ builds the starting book and is not measured
+struct Flow {
+    std::string name_;
+    std::vector<Command> prefill_;
+    std::vector<Command> commands_;
+};
+
+// Builds a flow against a shadow book, so cancels and modifies always target orders that are
+// still resting and prices are placed relative to the live touch
+class FlowBuilder {
+private:
+    struct Live {
+        Price price_;
+        Quantity remaining_;
+        Side side_;
+        std::size_t slot_;
+    };
+
+    std::mt19937_64 gen_;
+    OrderBook shadow_;
+    std::unordered_map<OrderId, Live> live_;
+    std::vector<OrderId> ids_;
+    OrderId nextId_{1};
+
+    void Insert(OrderId id, Price price, Quantity quantity, Side side) {
+        live_[id] = Live{ price, quantity, side, ids_.size() };
+        ids_.push_back(id);
+    }
+
+    void Remove(OrderId id) {
+        auto it = live_.find(id);
+        if (it == live_.end()) return;
+        std::size_t slot = it->second.slot_;
+        ids_[slot] = ids_.back();
+        live_[ids_[slot]].slot_ = slot;
+        ids_.pop_back();
+        live_.erase(it);
+    }
+
+    void Fill(OrderId id, Quantity quantity) {
+        auto it = live_.find(id);
+        if (it == live_.end()) return;
+        it->second.remaining_ -= quantity;
+        if (it->second.remaining_ == 0) Remove(id);
+    }
+
+public:
+    explicit FlowBuilder(std::uint64_t seed) : gen_{ seed } { }
+
+    std::uint64_t Roll(std::uint64_t n) { return gen_() % n; }
+    std::uint64_t Between(std::uint64_t lo, std::uint64_t hi) { return lo + gen_() % (hi - lo + 1); }
+    Side RandomSide() { return gen_() % 2 ? Side::BID : Side::ASK; }
+    std::size_t LiveCount() const { return ids_.size(); }
+
+    Price BestBid() const { auto best = shadow_.GetBestBid(); return best.quantity_ ? best.price_ : kMid - 1; }
+    Price BestAsk() const { auto best = shadow_.GetBestAsk(); return best.quantity_ ? best.price_ : kMid + 1; }
+
+    // Price `ticks` behind the touch on side, never crossing
+    Price Passive(Side side, Price ticks) {
+        return side == Side::BID ? std::min(BestBid(), BestAsk() - 1) - ticks : std::max(BestAsk(), BestBid() + 1) + ticks;
+    }
+
+    // Price `ticks` through the opposite touch
+    Price Aggressive(Side side, Price ticks) {
+        return side == Side::BID ? BestAsk() + ticks : BestBid() - ticks;
+    }
+
+    // Live order, picked uniformly or, with recent set, among the newest
+    OrderId PickLive(bool recent = false) {
+        std::size_t window = std::min<std::size_t>(ids_.size(), 64);
+        return recent ? ids_[ids_.size() - 1 - Roll(window)] : ids_[Roll(ids_.size())];
+    }
+
+    void Add(std::vector<Command>& out, Side side, Price price, Quantity quantity, OrderType type = OrderType::GoodTillCancel) {
+        OrderId id = nextId_++;
+        Emit(out, Command::Add(Order(id, price, quantity, side, type)));
+    }
+
+    void Cancel(std::vector<Command>& out, OrderId id) { Emit(out, Command::Cancel(id)); }
+
+    void Modify(std::vector<Command>& out, OrderId id, Price ticks, Quantity quantity) {
+        Side side = live_.at(id).side_;
+        Emit(out, Command::Modify(id, Passive(side, ticks), quantity, side));
+    }
+
+    // Same price, smaller size: the market-maker amend that keeps queue priority
+    void Reduce(std::vector<Command>& out, OrderId id) {
+        const Live& live = live_.at(id);
+        Emit(out, Command::Modify(id, live.price_, static_cast<Quantity>(Between(1, live.remaining_)), live.side_));
+    }
+
+    void Emit(std::vector<Command>& out, const Command& command) {
+        out.push_back(command);
+        if (command.type_ != CommandType::Add) Remove(command.orderId_);
+        if (command.type_ != CommandType::Cancel) Insert(command.orderId_, command.price_, command.quantity_, command.side_);
+        for (const auto& trade : ApplyCommand(shadow_, command)) {
+            Fill(trade.GetBidTrade().orderId_, trade.GetBidTrade().quantity_);
+            Fill(trade.GetAskTrade().orderId_, trade.GetAskTrade().quantity_);
+        }
+        // immediate orders never rest, whether they traded or were rejected
+        if (command.type_ == CommandType::Add && command.orderType_ != OrderType::GoodTillCancel
+            && command.orderType_ != OrderType::GoodForDay && command.orderType_ != OrderType::Market)
+            Remove(command.orderId_);
+    }
+};
+
+// 500k resting orders 5000 ticks deep per side; mostly passive flow with some takers
+Flow DeepBook(std::uint64_t seed, std::size_t commands) {
+    Flow flow{ "deep_book", {}, {} };
+    FlowBuilder builder{ seed };
+    for (std::size_t i = 0; i < 500'000; ++i) {
+        Side side = i % 2 ? Side::BID : Side::ASK;
+        builder.Add(flow.prefill_, side, side == Side::BID ? kMid - 1 - builder.Roll(5000) : kMid + 1 + builder.Roll(5000), builder.Between(1, 100));
+    }
+    while (flow.commands_.size() < commands) {
+        auto roll = builder.Roll(100);
+        Side side = builder.RandomSide();
+        if (roll < 50 || builder.LiveCount() == 0) builder.Add(flow.commands_, side, builder.Passive(side, builder.Roll(50)), builder.Between(1, 100));
+        else if (roll < 60) builder.Add(flow.commands_, side, builder.Aggressive(side, builder.Roll(3)), builder.Between(1, 200));
+        else if (roll < 85) builder.Cancel(flow.commands_, builder.PickLive());
+        else builder.Modify(flow.commands_, builder.PickLive(), builder.Roll(50), builder.Between(1, 100));
+    }
+    return flow;
+}
+
+// Short-lived quotes: most orders are cancelled soon after they are placed
+Flow CancelHeavy(std::uint64_t seed, std::size_t commands) {
+    Flow flow{ "cancel_heavy", {}, {} };
+    FlowBuilder builder{ seed };
+    for (std::size_t i = 0; i < 50'000; ++i) {
+        Side side = i % 2 ? Side::BID : Side::ASK;
+        builder.Add(flow.prefill_, side, side == Side::BID ? kMid - 1 - builder.Roll(200) : kMid + 1 + builder.Roll(200), builder.Between(1, 100));
+    }
+    while (flow.commands_.size() < commands) {
+        auto roll = builder.Roll(100);
+        Side side = builder.RandomSide();
+        if (roll < 40 || builder.LiveCount() < 20'000) builder.Add(flow.commands_, side, builder.Passive(side, builder.Roll(10)), builder.Between(1, 100));
+        else if (roll < 45) builder.Add(flow.commands_, side, builder.Aggressive(side, 0), builder.Between(1, 50));
+        else builder.Cancel(flow.commands_, builder.PickLive(builder.Roll(100) < 80));
+    }
+    return flow;
+}
+
+// Large takers that walk through many levels, with passive flow refilling behind them
+Flow Sweep(std::uint64_t seed, std::size_t commands) {
+    Flow flow{ "sweep", {}, {} };
+    FlowBuilder builder{ seed };
+    for (std::size_t i = 0; i < 200'000; ++i) {
+        Side side = i % 2 ? Side::BID : Side::ASK;
+        builder.Add(flow.prefill_, side, side == Side::BID ? kMid - 1 - builder.Roll(2000) : kMid + 1 + builder.Roll(2000), builder.Between(1, 100));
+    }
+    while (flow.commands_.size() < commands) {
+        Side side = builder.RandomSide();
+        if (builder.Roll(100) < 10) builder.Add(flow.commands_, side, builder.Aggressive(side, builder.Between(5, 50)), builder.Between(2'000, 20'000));
+        else builder.Add(flow.commands_, side, builder.Passive(side, builder.Roll(100)), builder.Between(1, 100));
+    }
+    return flow;
+}
+
+// Takers using FillAndKill, FillOrKill and Market, many of which cannot trade as asked
+Flow Immediate(std::uint64_t seed, std::size_t commands) {
+    Flow flow{ "immediate", {}, {} };
+    FlowBuilder builder{ seed };
+    for (std::size_t i = 0; i < 100'000; ++i) {
+        Side side = i % 2 ? Side::BID : Side::ASK;
+        builder.Add(flow.prefill_, side, side == Side::BID ? kMid - 1 - builder.Roll(500) : kMid + 1 + builder.Roll(500), builder.Between(1, 100));
+    }
+    while (flow.commands_.size() < commands) {
+        auto roll = builder.Roll(100);
+        Side side = builder.RandomSide();
+        if (roll < 50 || builder.LiveCount() < 20'000) builder.Add(flow.commands_, side, builder.Passive(side, builder.Roll(20)), builder.Between(1, 100));
+        else if (roll < 65) builder.Add(flow.commands_, side, builder.Aggressive(side, static_cast<Price>(builder.Roll(3)) - 1), builder.Between(1, 100), OrderType::FillAndKill);
+        else if (roll < 85) builder.Add(flow.commands_, side, builder.Aggressive(side, builder.Roll(3)), builder.Between(1, 300), OrderType::FillOrKill);
+        else if (roll < 88) builder.Add(flow.commands_, side, 0, builder.Between(1, 50), OrderType::Market);
+        else builder.Cancel(flow.commands_, builder.PickLive());
+    }
+    return flow;
+}
+
+// Market-maker flow where half the traffic amends resting quotes, mostly downsizing them in place
+Flow Amend(std::uint64_t seed, std::size_t commands) {
+    Flow flow{ "amend", {}, {} };
+    FlowBuilder builder{ seed };
+    for (std::size_t i = 0; i < 100'000; ++i) {
+        Side side = i % 2 ? Side::BID : Side::ASK;
+        builder.Add(flow.prefill_, side, side == Side::BID ? kMid - 1 - builder.Roll(500) : kMid + 1 + builder.Roll(500), builder.Between(1, 100));
+    }
+    while (flow.commands_.size() < commands) {
+        auto roll = builder.Roll(100);
+        Side side = builder.RandomSide();
+        if (roll < 30 || builder.LiveCount() < 20'000) builder.Add(flow.commands_, side, builder.Passive(side, builder.Roll(20)), builder.Between(1, 100));
+        else if (roll < 35) builder.Add(flow.commands_, side, builder.Aggressive(side, 0), builder.Between(1, 50));
+        else if (roll < 50) builder.Cancel(flow.commands_, builder.PickLive());
+        else if (roll < 90) builder.Reduce(flow.commands_, builder.PickLive());
+        else builder.Modify(flow.commands_, builder.PickLive(), builder.Roll(20), builder.Between(1, 100));
+    }
+    return flow;
+}
+
+enum class Operation
+{
+	Add,
+	Match,
+	Cancel,
+	Modify
+};
+
+constexpr const char* kOperationNames[] = { "add", "match", "cancel", "modify" };
+
+struct Result {
+    std::string scenario_;
+    std::uint64_t commands_{0};
+    std::uint64_t trades_{0};
+    std::size_t resting_{0};
+    double seconds_{0};
+    HdrHistogram latency_[4];
+};
+
+Operation Classify(const Command& command, const Trades& trades) {
+    switch (command.type_) {
+    case CommandType::Add: return trades.empty() ? Operation::Add : Operation::Match;
+    case CommandType::Cancel: return Operation::Cancel;
+    case CommandType::Modify: return Operation::Modify;
+    case CommandType::AdvanceClock: return Operation::Cancel;   // expiries are cancels
+    case CommandType::CancelSide:
+    case CommandType::CancelRange:
+    case CommandType::CancelOwner: return Operation::Cancel;
+    }
+    return Operation::Add;
+}
+
+// Books per symbol, so recorded multi-symbol journals replay too
+using Books = std::unordered_map<Symbol, OrderBook>;
+
+Trades Apply(Books& books, const Command& command) {
+    try {
+        return ApplyCommand(books[command.symbol_], command);
+    } catch (const std::exception&) {
+        return {};
+    }
+}
+
+// One untimed pass for throughput, then a fresh book with every command timed
+Result Run(const std::string& name, const std::vector<Command>& prefill, const std::vector<Command>& commands) {
+    Result result;
+    result.scenario_ = name;
+    result.commands_ = commands.size();
+    {
+        Books books;
+        books[0].ReserveOrders(prefill.size() + commands.size());
+        for (const auto& command : prefill) Apply(books, command);
+        auto nanos = TimeNanos([&] {
+            for (const auto& command : commands) result.trades_ += Apply(books, command).size();
+        });
+        result.seconds_ = nanos / 1e9;
+        for (const auto& [symbol, book] : books) result.resting_ += book.Size();
+    }
+
+    Books books;
+    books[0].ReserveOrders(prefill.size() + commands.size());
+    for (const auto& command : prefill) Apply(books, command);
+    for (const auto& command : commands) {
+        auto start = std::chrono::steady_clock::now();
+        Trades trades = Apply(books, command);
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        result.latency_[static_cast<int>(Classify(command, trades))].Record(static_cast<std::uint64_t>(nanos));
+    }
+    return result;
+}
+
+void PrintText(const Result& result) {
+    std::cout << result.scenario_ << ": " << result.commands_ << " commands in " << std::fixed << std::setprecision(3)
+              << result.seconds_ << "s = " << static_cast<std::uint64_t>(result.commands_ / result.seconds_) << " cmd/s, "
+              << result.trades_ << " trades, " << result.resting_ << " resting\n";
+    for (int op = 0; op < 4; ++op) {
+        const auto& h = result.latency_[op];
+        std::cout << "  " << std::left << std::setw(8) << kOperationNames[op] << std::right
+                  << " n=" << std::setw(9) << h.Count()
+                  << " p50=" << std::setw(7) << h.Percentile(50)
+                  << " p99=" << std::setw(7) << h.Percentile(99)
+                  << " p99.9=" << std::setw(7) << h.Percentile(99.9)
+                  << " max=" << std::setw(9) << h.Max() << " ns\n";
+    }
+}
+
+std::string ToJson(const std::vector<Result>& results, const std::string& label, std::uint64_t seed) {
+    std::ostringstream out;
+    out << "{\n  \"label\": \"" << label << "\",\n  \"seed\": " << seed << ",\n  \"scenarios\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << (i ? "," : "") << "\n    {\n"
+            << "      \"name\": \"" << result.scenario_ << "\",\n"
+            << "      \"commands\": " << result.commands_ << ",\n"
+            << "      \"trades\": " << result.trades_ << ",\n"
+            << "      \"resting\": " << result.resting_ << ",\n"
+            << "      \"seconds\": " << result.seconds_ << ",\n"
+            << "      \"commands_per_second\": " << static_cast<std::uint64_t>(result.commands_ / result.seconds_) << ",\n"
+            << "      \"latency_ns\": {";
+        for (int op = 0; op < 4; ++op) {
+            const auto& h = result.latency_[op];
+            out << (op ? "," : "") << "\n        \"" << kOperationNames[op] << "\": { \"count\": " << h.Count()
+                << ", \"mean\": " << static_cast<std::uint64_t>(h.Mean())
+                << ", \"p50\": " << h.Percentile(50) << ", \"p99\": " << h.Percentile(99)
+                << ", \"p99_9\": " << h.Percentile(99.9) << ", \"max\": " << h.Max() << " }";
+        }
+        out << "\n      }\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
+
+// Writes prefill + commands as a journal, so the flow can be replayed later with --journal
+void Record(const std::string& directory, const Flow& flow) {
+    std::filesystem::remove_all(directory);
+    Journal journal{ JournalConfig{ directory } };
+    for (const auto& command : flow.prefill_) journal.Append(command);
+    for (const auto& command : flow.commands_) journal.Append(command);
+    journal.WaitDurable(journal.GetSequence());
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string scenario = "all", journal, record, json, label = "local";
+    std::uint64_t seed = 42;
+    std::size_t commands = 2'000'000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i], value = argv[i + 1];
+        if (flag == "--scenario") scenario = value;
+        else if (flag == "--seed") seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (flag == "--commands") commands = std::strtoull(value.c_str(), nullptr, 10);
+        else if (flag == "--journal") journal = value;
+        else if (flag == "--record") record = value;
+        else if (flag == "--json") json = value;
+        else if (flag == "--label") label = value;
+        else {
+            std::cerr << "unknown flag " << flag << "\n";
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    if (!journal.empty()) {
+        std::vector<Command> recorded;
+        ReadJournal(journal, 0, [&](const JournalRecord& entry) { recorded.push_back(entry.command_); });
+        results.push_back(Run("journal:" + journal, {}, recorded));
+    } else {
+        std::map<std::string, Flow (*)(std::uint64_t, std::size_t)> scenarios{
+            { "deep_book", DeepBook }, { "cancel_heavy", CancelHeavy }, { "sweep", Sweep }, { "immediate", Immediate }, { "amend", Amend } };
+        for (const auto& [name, make] : scenarios) {
+            if (scenario != "all" && scenario != name) continue;
+            Flow flow = make(seed, commands);
+            if (!record.empty()) Record(scenario == "all" ? record + "/" + name : record, flow);
+            results.push_back(Run(flow.name_, flow.prefill_, flow.commands_));
+        }
+        if (results.empty()) {
+            std::cerr << "unknown scenario " << scenario << "\n";
+            return 2;
+        }
+    }
+
+    std::string report = ToJson(results, label, seed);
+    if (json == "-") {
+        std::cout << report;
+    } else {
+        for (const auto& result : results) PrintText(result);
+        if (!json.empty()) std::ofstream(json) << report;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Stop orders at scale: parks [stops] buy stops above a thin ask side, then one taker lifts the
+// touch and sets off a cascade. Each tick of stops takes more than the tick holds, so the price
+// climbs through every thin tick, firing the stops there, until it reaches a wall of liquidity
+// [wall] ticks up. Reports the cost per stop parked and fired, what rescanning every pending stop
+// after each trade would cost instead, and passive add latency with and without the stops parked.
+// build: g++ -std=c++20 -O3 -Isrc -Ibench bench/stop_bench.cpp -o stop_bench
+// usage: stop_bench [stops] [wall ticks]    (default 1M, 200)
+#include "orderbook.h"
+#include "LatencyStats.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+constexpr Price kMid = 100'000;
+constexpr Price kStopBand = 20'000;       // buy stops are spread evenly over (kMid, kMid + kStopBand]
+constexpr Quantity kThinDepth = 40;       // per ask tick below the wall: less than the stops parked there
+constexpr Quantity kWallDepth = 1'000'000'000;
+constexpr Price kStopLimitReach = 5;      // a stop-limit buys up to this many ticks past its stop
+constexpr std::size_t kPassiveAdds = 200'000;
+constexpr int kRounds = 3;
+
+// Thin asks from the touch up to the wall, a wall behind them and bids below the mid
+void Quote(OrderBook& book, Price wall, OrderId& nextId) {
+    for (Price tick = 1; tick <= wall; ++tick)
+        book.Add(Order(nextId++, kMid + tick, kThinDepth, Side::ASK, OrderType::GoodTillCancel));
+    book.Add(Order(nextId++, kMid + wall + 1, kWallDepth, Side::ASK, OrderType::GoodTillCancel));
+    for (Price tick = 1; tick <= 1'000; ++tick)
+        book.Add(Order(nextId++, kMid - tick, kThinDepth, Side::BID, OrderType::GoodTillCancel));
+}
+
+// One in four is a stop-limit; the rest become Market orders when they fire
+void ParkStops(OrderBook& book, std::size_t stops, OrderId& nextId) {
+    for (std::size_t i = 0; i < stops; ++i) {
+        Price stop = kMid + 1 + static_cast<Price>(i % kStopBand);
+        if (i % 4 == 0) book.Add(Order(nextId++, stop + kStopLimitReach, 1, Side::BID, OrderType::StopLimit, stop));
+        else book.Add(Order(nextId++, 0, 1, Side::BID, OrderType::Stop, stop));
+    }
+}
+
+// Passive bids behind the touch, each cancelled again, so the book ends where it started
+void PassiveAdds(OrderBook& book, OrderId& nextId, LatencyStats& stats) {
+    for (std::size_t i = 0; i < kPassiveAdds; ++i) {
+        OrderId id = nextId++;
+        Order order(id, kMid - 1 - static_cast<Price>(i % 1'000), 10, Side::BID, OrderType::GoodTillCancel);
+        stats.Record(TimeNanos([&] { book.Add(order); }));
+        book.CancelOrder(id);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::size_t stops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    Price wall = argc > 2 ? std::strtoll(argv[2], nullptr, 10) : 200;
+
+    double parkNanos = 1e18, fireNanos = 1e18, scanNanos = 1e18;
+    std::size_t fired = 0, trades = 0;
+    LatencyStats withStops{ "add, stops parked", kPassiveAdds * kRounds };
+    LatencyStats withoutStops{ "add, no stops", kPassiveAdds * kRounds };
+
+    for (int round = 0; round < kRounds; ++round) {
+        OrderBook book;
+        book.ReserveOrders(stops + kPassiveAdds + 2'000 + static_cast<std::size_t>(wall));
+        OrderId nextId = 1;
+        Quote(book, wall, nextId);
+        // a first trade below every stop, so the book has a last price and adds check the triggers
+        book.Add(Order(nextId++, kMid - 1, 1, Side::ASK, OrderType::FillAndKill));
+
+        auto parked = TimeNanos([&] { ParkStops(book, stops, nextId); });
+        parkNanos = std::min(parkNanos, static_cast<double>(parked) / stops);
+        PassiveAdds(book, nextId, withStops);
+
+        // what a book without a trigger index would do: look at every pending stop per trade
+        std::vector<Price> stopPrices;
+        stopPrices.reserve(stops);
+        book.ForEachOrder([&](const Order& order) { if (order.IsStop()) stopPrices.push_back(order.GetStopPrice()); });
+        std::size_t reached = 0;
+        auto scanned = TimeNanos([&] { for (Price stop : stopPrices) reached += stop <= kMid + wall; });
+        scanNanos = std::min(scanNanos, static_cast<double>(scanned));
+
+        Trades fills;
+        fills.reserve(1 << 20);
+        std::size_t pending = book.GetStopCount();
+        Order taker(nextId++, kMid + 1, kThinDepth, Side::BID, OrderType::GoodTillCancel);
+        auto swept = TimeNanos([&] { book.Apply(Command::Add(taker), fills); });
+        fired = pending - book.GetStopCount();
+        trades = fills.size();
+        if (fired == 0 || reached == 0) {
+            std::cerr << "no stops fired\n";
+            return 1;
+        }
+        fireNanos = std::min(fireNanos, static_cast<double>(swept) / fired);
+
+        OrderBook empty;
+        empty.ReserveOrders(kPassiveAdds + 2'000 + static_cast<std::size_t>(wall));
+        OrderId emptyId = 1;
+        Quote(empty, wall, emptyId);
+        empty.Add(Order(emptyId++, kMid - 1, 1, Side::ASK, OrderType::FillAndKill));
+        PassiveAdds(empty, emptyId, withoutStops);
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << stops << " stops parked, " << fired << " fired by one taker in " << trades << " trades, best of " << kRounds << "\n"
+              << "park:    " << parkNanos << " ns/stop\n"
+              << "fire:    " << fireNanos << " ns/stop fired, cascade included\n"
+              << "rescan:  " << scanNanos / 1e6 << " ms per pass over every pending stop, "
+              << scanNanos * trades / 1e9 << " s for the cascade's trades\n";
+    withStops.Print();
+    withoutStops.Print();
+    return 0;
+}
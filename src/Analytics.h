@@ -0,0 +1,185 @@
+#pragma once
+#include "SeqLock.h"
+#include "Trade.h"
+#include "using.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+constexpr std::size_t kMaxBarIntervals = 4;
+constexpr std::size_t kVwapBuckets = 64;
+constexpr std::size_t kImbalanceDepth = 5;
+
+struct AnalyticsConfig {
+    std::vector<Timestamp> barIntervals_{ 1'000'000'000ll, 60'000'000'000ll, 300'000'000'000ll };   // 1s, 1m, 5m
+    Timestamp vwapWindow_{ 300'000'000'000ll };   // windowed VWAP covers about the last 5m
+};
+
+// One OHLCV bar. A bar with no trades is flat at the previous close; all zero before the first
+// trade. Intervals in which nothing at all was folded in are skipped, not filled.
+struct Bar {
+    Timestamp start_{0};
+    Price open_{0};
+    Price high_{0};
+    Price low_{0};
+    Price close_{0};
+    std::uint64_t volume_{0};
+    std::uint64_t trades_{0};
+    std::int64_t notional_{0};   // sum of price x quantity
+
+    double Vwap() const { return volume_ ? static_cast<double>(notional_) / volume_ : 0.0; }
+};
+
+// What readers see: the open and the last closed bar per interval, cumulative and windowed VWAP
+// and top-of-book imbalance, all as of time_
+struct AnalyticsSnapshot {
+    Timestamp time_{0};
+    std::uint32_t intervalCount_{0};
+    Timestamp intervals_[kMaxBarIntervals]{};
+    Bar current_[kMaxBarIntervals]{};
+    Bar last_[kMaxBarIntervals]{};
+    std::uint64_t trades_{0};
+    std::uint64_t volume_{0};
+    std::int64_t notional_{0};
+    std::uint64_t windowVolume_{0};
+    std::int64_t windowNotional_{0};
+    Quantity bidTop_{0};              // quantity at the best bid / ask
+    Quantity askTop_{0};
+    std::uint64_t bidDepth_{0};       // quantity over the best kImbalanceDepth levels
+    std::uint64_t askDepth_{0};
+
+    double Vwap() const { return volume_ ? static_cast<double>(notional_) / volume_ : 0.0; }
+    double WindowVwap() const { return windowVolume_ ? static_cast<double>(windowNotional_) / windowVolume_ : 0.0; }
+
+    // (bid - ask) / (bid + ask) in [-1, 1]; 0 when both are empty
+    static double Imbalance(std::uint64_t bid, std::uint64_t ask) {
+        return bid + ask ? (static_cast<double>(bid) - static_cast<double>(ask)) / static_cast<double>(bid + ask) : 0.0;
+    }
+    double ImbalanceL1() const { return Imbalance(bidTop_, askTop_); }
+    double ImbalanceL5() const { return Imbalance(bidDepth_, askDepth_); }
+};
+
+inline Timestamp WallNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Streaming trade and book statistics for one instrument, updated as trades happen instead of by
+// re-reading history. One writer thread folds in trades (OnTrade) and the top of the book (OnBook)
+// at a cost independent of history: O(intervals) per trade plus, once time moves on, clearing the
+// VWAP window buckets it left behind (at most kVwapBuckets, amortized O(1)). Publish makes the
+// state visible through a SeqLock, so any thread reads a consistent copy without blocking it.
+// Bars are aligned to multiples of their interval since the epoch. Notional is exact integer
+// price x quantity, good for 9.2e18 of it.
+class MarketAnalytics {
+private:
+    AnalyticsSnapshot state_;   // writer's working copy
+    Timestamp bucketWidth_;
+    std::int64_t newestBucket_{0};
+    std::array<std::uint64_t, kVwapBuckets> bucketVolume_{};
+    std::array<std::int64_t, kVwapBuckets> bucketNotional_{};
+    SeqLock<AnalyticsSnapshot> published_;
+
+    void AdvanceWindow(Timestamp now) {
+        std::int64_t bucket = now / bucketWidth_;
+        if (bucket <= newestBucket_) return;
+        std::int64_t first = std::max(newestBucket_ + 1, bucket - static_cast<std::int64_t>(kVwapBuckets) + 1);
+        for (std::int64_t b = first; b <= bucket; ++b) {
+            std::size_t slot = static_cast<std::size_t>(b) % kVwapBuckets;
+            state_.windowVolume_ -= bucketVolume_[slot];
+            state_.windowNotional_ -= bucketNotional_[slot];
+            bucketVolume_[slot] = 0;
+            bucketNotional_[slot] = 0;
+        }
+        newestBucket_ = bucket;
+    }
+
+    void AdvanceBars(Timestamp now) {
+        for (std::size_t i = 0; i < state_.intervalCount_; ++i) {
+            Bar& bar = state_.current_[i];
+            Timestamp interval = state_.intervals_[i];
+            if (now < bar.start_ + interval) continue;
+            state_.last_[i] = bar;
+            Price close = bar.close_;
+            bar = Bar{ now - now % interval, close, close, close, close };
+        }
+    }
+
+public:
+    explicit MarketAnalytics(const AnalyticsConfig& config = {}) {
+        if (config.barIntervals_.size() > kMaxBarIntervals)
+            throw std::invalid_argument(std::format("At most {} bar intervals are kept.", kMaxBarIntervals));
+        for (Timestamp interval : config.barIntervals_)
+            if (interval <= 0) throw std::invalid_argument("Bar intervals must be positive.");
+        if (config.vwapWindow_ <= 0) throw std::invalid_argument("The VWAP window must be positive.");
+        state_.intervalCount_ = static_cast<std::uint32_t>(config.barIntervals_.size());
+        std::copy(config.barIntervals_.begin(), config.barIntervals_.end(), state_.intervals_);
+        bucketWidth_ = std::max<Timestamp>(1, (config.vwapWindow_ + kVwapBuckets - 1) / kVwapBuckets);
+        published_.Store(state_);
+    }
+
+    // Writer thread only. Closes the bars and ages the VWAP window up to now; time never goes
+    // back, an earlier now is taken as the latest time seen.
+    void Advance(Timestamp now) {
+        if (now <= state_.time_) return;
+        state_.time_ = now;
+        AdvanceBars(now);
+        AdvanceWindow(now);
+    }
+
+    // Writer thread only: one execution of quantity at price
+    void OnTrade(Price price, Quantity quantity, Timestamp now) {
+        Advance(now);
+        std::int64_t notional = price * static_cast<std::int64_t>(quantity);
+        for (std::size_t i = 0; i < state_.intervalCount_; ++i) {
+            Bar& bar = state_.current_[i];
+            if (bar.trades_ == 0) bar.open_ = bar.high_ = bar.low_ = price;
+            bar.high_ = std::max(bar.high_, price);
+            bar.low_ = std::min(bar.low_, price);
+            bar.close_ = price;
+            bar.volume_ += quantity;
+            bar.notional_ += notional;
+            ++bar.trades_;
+        }
+        ++state_.trades_;
+        state_.volume_ += quantity;
+        state_.notional_ += notional;
+        std::size_t slot = static_cast<std::size_t>(newestBucket_) % kVwapBuckets;
+        bucketVolume_[slot] += quantity;
+        bucketNotional_[slot] += notional;
+        state_.windowVolume_ += quantity;
+        state_.windowNotional_ += notional;
+    }
+
+    void OnTrades(std::span<const Trade> trades, Timestamp now) {
+        for (const Trade& trade : trades) OnTrade(trade.GetPrice(), trade.GetQuantity(), now);
+    }
+
+    // Writer thread only: takes the imbalance inputs from the best kImbalanceDepth levels of book
+    template <typename Book>
+    void OnBook(const Book& book) {
+        std::array<LevelInfo, kImbalanceDepth> levels;
+        auto sum = [&](std::size_t count) {
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < count; ++i) total += levels[i].quantity_;
+            return total;
+        };
+        std::size_t count = book.GetBids(std::span<LevelInfo>(levels));
+        state_.bidTop_ = count ? levels[0].quantity_ : 0;
+        state_.bidDepth_ = sum(count);
+        count = book.GetAsks(std::span<LevelInfo>(levels));
+        state_.askTop_ = count ? levels[0].quantity_ : 0;
+        state_.askDepth_ = sum(count);
+    }
+
+    // Writer thread only: makes everything folded in so far visible to readers
+    void Publish() { published_.Store(state_); }
+
+    // Any thread; the state as of the last Publish
+    AnalyticsSnapshot Load() const { return published_.Load(); }
+};
@@ -0,0 +1,414 @@
+#pragma once
+#include "Journal.h"
+#include "WorkStealingPool.h"
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <iomanip>
+#include <optional>
+#include <set>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Offline replay of recorded order flow: every input file (typically one symbol-day) is an
+// independent job replayed through its own books, one per symbol it mentions, on a
+// WorkStealingPool. Each job writes <stem>.trades.csv and <stem>.summary.json to the output
+// directory; RunBacktest also writes backtest.json with every job and the totals.
+//
+// Order files come in two forms, told apart by extension:
+//  .csv  one command per line, '#' starts a comment line, the symbol column is optional (0):
+//          A,<id>,<B|S>,<GTC|FAK|FOK|GFD|MKT>,<price>,<quantity>[,<symbol>]   add
+//          S,<id>,<B|S>,<STP|STL>,<stop>,<limit>,<quantity>[,<symbol>]      add a stop (limit unused by STP)
+//          X,<id>[,<symbol>]                                                 cancel
+//          M,<id>,<B|S>,<price>,<quantity>[,<symbol>]                        modify
+//          T,<nanoseconds>[,<symbol>]                                        advance the clock
+//  other an OrderFileHeader followed by that many Command records, as WriteOrderFile writes
+//        them; read straight from a read-only mapping
+
+constexpr std::uint64_t kOrderFileMagic = 0x333053444D43424Full;   // "OBCMDS03"
+
+struct OrderFileHeader {
+    std::uint64_t magic_;
+    std::uint64_t count_;
+};
+
+inline void WriteOrderFile(const std::filesystem::path& path, std::span<const Command> commands) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) throw std::system_error(errno, std::generic_category(), "open " + path.string());
+    OrderFileHeader header{ kOrderFileMagic, commands.size() };
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && std::fwrite(commands.data(), sizeof(Command), commands.size(), file) == commands.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) throw std::runtime_error(std::format("Could not write order file {}.", path.string()));
+}
+
+class OrderFileParser {
+private:
+    const std::filesystem::path& path_;
+    std::size_t line_{0};
+
+    [[noreturn]] void Fail(std::string_view what) const {
+        throw std::runtime_error(std::format("{}:{}: {}", path_.string(), line_, what));
+    }
+
+    template <typename T>
+    T Number(std::string_view field) const {
+        T value{};
+        auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (error != std::errc{} || end != field.data() + field.size()) Fail(std::format("bad number '{}'", field));
+        return value;
+    }
+
+    Side SideOf(std::string_view field) const {
+        if (field == "B") return Side::BID;
+        if (field == "S") return Side::ASK;
+        Fail(std::format("bad side '{}'", field));
+    }
+
+    OrderType TypeOf(std::string_view field) const {
+        if (field == "GTC") return OrderType::GoodTillCancel;
+        if (field == "FAK") return OrderType::FillAndKill;
+        if (field == "FOK") return OrderType::FillOrKill;
+        if (field == "GFD") return OrderType::GoodForDay;
+        if (field == "MKT") return OrderType::Market;
+        Fail(std::format("bad order type '{}'", field));
+    }
+
+    OrderType StopTypeOf(std::string_view field) const {
+        if (field == "STP") return OrderType::Stop;
+        if (field == "STL") return OrderType::StopLimit;
+        Fail(std::format("bad stop type '{}'", field));
+    }
+
+public:
+    explicit OrderFileParser(const std::filesystem::path& path)
+        : path_{ path }
+    { }
+
+    Command Parse(std::string_view text) {
+        ++line_;
+        std::string_view fields[8];
+        std::size_t count = 0;
+        while (true) {
+            std::size_t comma = text.find(',');
+            if (count == std::size(fields)) Fail("too many fields");
+            fields[count++] = text.substr(0, comma);
+            if (comma == std::string_view::npos) break;
+            text.remove_prefix(comma + 1);
+        }
+
+        auto symbolAt = [&](std::size_t index) { return count > index ? Number<Symbol>(fields[index]) : Symbol{ 0 }; };
+        auto expect = [&](std::size_t required) { if (count != required && count != required + 1) Fail("wrong number of fields"); };
+        if (fields[0] == "A") {
+            expect(6);
+            Order order(Number<OrderId>(fields[1]), Number<Price>(fields[4]), Number<Quantity>(fields[5]), SideOf(fields[2]), TypeOf(fields[3]));
+            return Command::Add(order, symbolAt(6));
+        }
+        if (fields[0] == "S") {
+            expect(7);
+            Order order(Number<OrderId>(fields[1]), Number<Price>(fields[5]), Number<Quantity>(fields[6]), SideOf(fields[2]),
+                StopTypeOf(fields[3]), Number<Price>(fields[4]));
+            return Command::Add(order, symbolAt(7));
+        }
+        if (fields[0] == "X") {
+            expect(2);
+            return Command::Cancel(Number<OrderId>(fields[1]), symbolAt(2));
+        }
+        if (fields[0] == "M") {
+            expect(5);
+            return Command::Modify(Number<OrderId>(fields[1]), Number<Price>(fields[3]), Number<Quantity>(fields[4]), SideOf(fields[2]), symbolAt(5));
+        }
+        if (fields[0] == "T") {
+            expect(2);
+            return Command::AdvanceClock(Number<Timestamp>(fields[1]), symbolAt(2));
+        }
+        Fail(std::format("unknown command '{}'", fields[0]));
+    }
+
+    // Comment and blank lines still count towards line numbers
+    void Skip() { ++line_; }
+};
+
+// Calls f(command) for every command in an order file, in file order
+template <typename F>
+void ReadOrderFile(const std::filesystem::path& path, F&& f) {
+    MappedFile file{ path };
+    const char* data = reinterpret_cast<const char*>(file.Data());
+    if (path.extension() == ".csv") {
+        OrderFileParser parser{ path };
+        std::string_view rest{ data, file.Size() };
+        while (!rest.empty()) {
+            std::size_t newline = rest.find('\n');
+            std::string_view line = rest.substr(0, newline);
+            rest.remove_prefix(newline == std::string_view::npos ? rest.size() : newline + 1);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.empty() || line.front() == '#') parser.Skip();
+            else f(parser.Parse(line));
+        }
+        return;
+    }
+
+    OrderFileHeader header{};
+    if (file.Size() >= sizeof(header)) std::memcpy(&header, data, sizeof(header));
+    if (header.magic_ != kOrderFileMagic && (header.magic_ & 0xFFFFFFFFFFFFull) == (kOrderFileMagic & 0xFFFFFFFFFFFFull))
+        throw std::runtime_error(std::format("{} was written in an older order file format; write it again.", path.string()));
+    if (header.magic_ != kOrderFileMagic || header.count_ > (file.Size() - sizeof(header)) / sizeof(Command))
+        throw std::runtime_error(std::format("{} is not an order file or is truncated.", path.string()));
+    for (std::uint64_t i = 0; i < header.count_; ++i) {
+        Command command;
+        std::memcpy(&command, data + sizeof(header) + i * sizeof(Command), sizeof(command));
+        f(command);
+    }
+}
+
+// Regular files under each path (a directory contributes its .csv and .cmd files), sorted
+inline std::vector<std::filesystem::path> ListOrderFiles(const std::vector<std::filesystem::path>& paths) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& path : paths) {
+        if (!std::filesystem::is_directory(path)) {
+            files.push_back(path);
+            continue;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(path)) {
+            auto extension = entry.path().extension();
+            if (entry.is_regular_file() && (extension == ".csv" || extension == ".cmd")) files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+struct BacktestConfig {
+    std::filesystem::path outputDirectory_;
+    PoolConfig pool_{};
+    std::optional<LadderConfig> ladder_;   // dense books for every symbol; map books otherwise
+    bool writeTrades_{true};
+};
+
+struct BacktestJobResult {
+    std::filesystem::path input_;
+    std::string error_;              // a job that fails stops there; the others carry on
+    std::uint64_t commands_{0};
+    std::uint64_t accepted_{0};
+    std::uint64_t rejected_{0};
+    std::uint64_t cancelled_{0};     // orders that left the book unfilled or part filled
+    std::uint64_t trades_{0};
+    std::uint64_t tradedQuantity_{0};
+    std::uint64_t resting_{0};       // orders still on the books at the end of the file
+    std::size_t symbols_{0};
+    std::size_t worker_{0};
+    std::uint64_t nanos_{0};
+};
+
+struct BacktestReport {
+    std::vector<BacktestJobResult> jobs_;
+    PoolRunStats pool_;
+    std::uint64_t commands_{0};
+    std::uint64_t trades_{0};
+    std::size_t failed_{0};
+
+    double EventsPerSecond() const { return pool_.wallNanos_ ? commands_ * 1e9 / pool_.wallNanos_ : 0.0; }
+};
+
+// Counts what the books report; trades come from the Trades adapter so they can be written out
+struct BacktestCounters {
+    std::uint64_t accepted_{0};
+    std::uint64_t rejected_{0};
+    std::uint64_t cancelled_{0};
+
+    void OnAccept(const OrderEvent&) { ++accepted_; }
+    void OnPartialFill(const OrderEvent&) { }
+    void OnFill(const OrderEvent&) { }
+    void OnCancel(const OrderEvent& event) { cancelled_ += event.status_ == OrderStatus::CANCELLED; }
+    void OnReject(const OrderEvent&, RejectReason) { ++rejected_; }
+};
+
+// Buffered CSV of one job's trades
+class TradeFileWriter {
+private:
+    std::filesystem::path path_;
+    FILE* file_{nullptr};
+    std::string buffer_;
+
+    void Flush() {
+        if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size())
+            throw std::runtime_error(std::format("Could not write {}.", path_.string()));
+        buffer_.clear();
+    }
+
+    template <typename T>
+    void Put(T value, char separator) {
+        char text[24];
+        auto end = std::to_chars(text, text + sizeof(text), value).ptr;
+        buffer_.append(text, end);
+        buffer_.push_back(separator);
+    }
+
+public:
+    explicit TradeFileWriter(std::filesystem::path path)
+        : path_{ std::move(path) }
+    {
+        file_ = std::fopen(path_.c_str(), "wb");
+        if (!file_) throw std::system_error(errno, std::generic_category(), "open " + path_.string());
+        buffer_ = "symbol,bid_order_id,ask_order_id,bid_price,ask_price,quantity\n";
+        buffer_.reserve(1 << 20);
+    }
+
+    ~TradeFileWriter() { if (file_) std::fclose(file_); }
+
+    TradeFileWriter(const TradeFileWriter&) = delete;
+    TradeFileWriter& operator=(const TradeFileWriter&) = delete;
+
+    void Write(Symbol symbol, const Trade& trade) {
+        Put(symbol, ',');
+        Put(trade.GetBidOrderId(), ',');
+        Put(trade.GetAskOrderId(), ',');
+        Put(trade.GetBidPrice(), ',');
+        Put(trade.GetAskPrice(), ',');
+        Put(trade.GetQuantity(), '\n');
+        if (buffer_.size() >= (1 << 20) - 128) Flush();
+    }
+
+    void Close() {
+        Flush();
+        bool ok = std::fclose(file_) == 0;
+        file_ = nullptr;
+        if (!ok) throw std::runtime_error(std::format("Could not write {}.", path_.string()));
+    }
+};
+
+inline void WriteTextFile(const std::filesystem::path& path, const std::string& text) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    bool ok = file && std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    ok = file && std::fclose(file) == 0 && ok;
+    if (!ok) throw std::runtime_error(std::format("Could not write {}.", path.string()));
+}
+
+inline void WriteJobJson(std::ostream& out, const BacktestJobResult& job) {
+    out << "{\"input\":" << std::quoted(job.input_.string()) << ",\"ok\":" << (job.error_.empty() ? "true" : "false");
+    if (!job.error_.empty()) out << ",\"error\":" << std::quoted(job.error_);
+    out << ",\"commands\":" << job.commands_ << ",\"accepted\":" << job.accepted_ << ",\"rejected\":" << job.rejected_
+        << ",\"cancelled\":" << job.cancelled_ << ",\"trades\":" << job.trades_ << ",\"traded_quantity\":" << job.tradedQuantity_
+        << ",\"resting\":" << job.resting_ << ",\"symbols\":" << job.symbols_ << ",\"worker\":" << job.worker_
+        << ",\"seconds\":" << job.nanos_ / 1e9
+        << ",\"commands_per_second\":" << static_cast<std::uint64_t>(job.nanos_ ? job.commands_ * 1e9 / job.nanos_ : 0) << "}";
+}
+
+// Stem of each input's outputs; two inputs may not share one
+inline std::string BacktestStem(const std::filesystem::path& input) { return input.stem().string(); }
+
+// Replays one order file; fills result and writes the job's outputs
+inline void RunBacktestJob(const BacktestConfig& config, const std::filesystem::path& input, BacktestJobResult& result, Trades& trades) {
+    using Book = BasicOrderBook<BacktestCounters>;
+    auto started = std::chrono::steady_clock::now();
+    result.input_ = input;
+    try {
+        std::string stem = BacktestStem(input);
+        std::optional<TradeFileWriter> writer;
+        if (config.writeTrades_) writer.emplace(config.outputDirectory_ / (stem + ".trades.csv"));
+
+        std::unordered_map<Symbol, Book> books;
+        Symbol lastSymbol = 0;
+        Book* book = nullptr;
+        ReadOrderFile(input, [&](const Command& command) {
+            if (!book || command.symbol_ != lastSymbol) {
+                auto it = books.find(command.symbol_);
+                if (it == books.end()) it = books.emplace(command.symbol_, config.ladder_ ? Book{ *config.ladder_ } : Book{}).first;
+                book = &it->second;
+                lastSymbol = command.symbol_;
+            }
+            trades.clear();
+            std::uint64_t reported = book->GetListener().rejected_;
+            try {
+                book->Apply(command, trades);
+            } catch (const std::exception&) {
+                // Bad prices and order types were reported to the listener too; a Modify with zero
+                // quantity or price, or a CancelOwner of owner 0, throws before the book sees it
+                if (book->GetListener().rejected_ == reported) ++result.rejected_;
+            }
+            ++result.commands_;
+            result.trades_ += trades.size();
+            for (const auto& trade : trades) {
+                result.tradedQuantity_ += trade.GetQuantity();
+                if (writer) writer->Write(command.symbol_, trade);
+            }
+        });
+        if (writer) writer->Close();
+
+        for (const auto& [symbol, symbolBook] : books) {
+            const auto& counters = symbolBook.GetListener();
+            result.accepted_ += counters.accepted_;
+            result.rejected_ += counters.rejected_;
+            result.cancelled_ += counters.cancelled_;
+            result.resting_ += symbolBook.Size();
+        }
+        result.symbols_ = books.size();
+    } catch (const std::exception& e) {
+        result.error_ = e.what();
+    }
+    result.nanos_ = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - started).count());
+
+    std::ostringstream summary;
+    WriteJobJson(summary, result);
+    summary << "\n";
+    WriteTextFile(config.outputDirectory_ / (BacktestStem(input) + ".summary.json"), summary.str());
+}
+
+// Replays every input on the pool. Inputs are costed by file size, so the largest days start first.
+inline BacktestReport RunBacktest(const BacktestConfig& config, const std::vector<std::filesystem::path>& inputs) {
+    std::set<std::string> stems;
+    for (const auto& input : inputs)
+        if (!stems.insert(BacktestStem(input)).second)
+            throw std::invalid_argument(std::format("Two inputs would both write {}.*; rename one.", BacktestStem(input)));
+    std::filesystem::create_directories(config.outputDirectory_);
+
+    std::vector<std::uint64_t> costs;
+    costs.reserve(inputs.size());
+    for (const auto& input : inputs) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(input, error);
+        costs.push_back(error ? 0 : size);
+    }
+
+    WorkStealingPool pool{ config.pool_ };
+    BacktestReport report;
+    report.jobs_.resize(inputs.size());
+    std::vector<Trades> buffers(pool.Threads());   // one reusable fill buffer per worker
+    report.pool_ = pool.Run(costs, [&](std::size_t job, std::size_t worker) {
+        report.jobs_[job].worker_ = worker;
+        RunBacktestJob(config, inputs[job], report.jobs_[job], buffers[worker]);
+    });
+
+    for (const auto& job : report.jobs_) {
+        report.commands_ += job.commands_;
+        report.trades_ += job.trades_;
+        report.failed_ += !job.error_.empty();
+    }
+
+    std::ostringstream out;
+    out << "{\"jobs\":" << report.jobs_.size() << ",\"failed\":" << report.failed_ << ",\"threads\":" << report.pool_.workers_.size()
+        << ",\"commands\":" << report.commands_ << ",\"trades\":" << report.trades_
+        << ",\"seconds\":" << report.pool_.wallNanos_ / 1e9
+        << ",\"events_per_second\":" << static_cast<std::uint64_t>(report.EventsPerSecond())
+        << ",\"imbalance\":" << report.pool_.Imbalance() << ",\"workers\":[";
+    for (std::size_t w = 0; w < report.pool_.workers_.size(); ++w) {
+        const auto& worker = report.pool_.workers_[w];
+        out << (w ? "," : "") << "{\"jobs\":" << worker.jobs_ << ",\"steals\":" << worker.steals_
+            << ",\"busy_seconds\":" << worker.busyNanos_ / 1e9 << "}";
+    }
+    out << "],\"results\":[";
+    for (std::size_t j = 0; j < report.jobs_.size(); ++j) {
+        out << (j ? "," : "");
+        WriteJobJson(out, report.jobs_[j]);
+    }
+    out << "]}\n";
+    WriteTextFile(config.outputDirectory_ / "backtest.json", out.str());
+    return report;
+}
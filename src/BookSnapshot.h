@@ -0,0 +1,30 @@
+#pragma once
+#include "Trade.h"
+#include "using.h"
+#include <cstddef>
+#include <cstdint>
+
+// Deepest L2 view the engine publishes
+constexpr std::size_t kMaxSnapshotDepth = 32;
+
+// Immutable, fixed-size copy of the top of a book: L1 is bids_[0]/asks_[0], L2 the first
+// bidCount_/askCount_ entries. sequence_ is the book's L2 delta sequence number at publication.
+struct BookSnapshot {
+    std::uint64_t sequence_{0};
+    Symbol symbol_{0};
+    std::uint32_t bidCount_{0};
+    std::uint32_t askCount_{0};
+    LevelInfo bids_[kMaxSnapshotDepth]{};
+    LevelInfo asks_[kMaxSnapshotDepth]{};
+
+    LevelInfo BestBid() const { return bidCount_ ? bids_[0] : LevelInfo{0, 0}; }
+    LevelInfo BestAsk() const { return askCount_ ? asks_[0] : LevelInfo{0, 0}; }
+
+    LevelInfos GetBids(std::size_t levels) const {
+        return LevelInfos(bids_, bids_ + (levels < bidCount_ ? levels : bidCount_));
+    }
+
+    LevelInfos GetAsks(std::size_t levels) const {
+        return LevelInfos(asks_, asks_ + (levels < askCount_ ? levels : askCount_));
+    }
+};
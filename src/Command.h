@@ -0,0 +1,119 @@
+#pragma once
+#include "order.h"
+#include "using.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+enum class CommandType : std::uint8_t
+{
+	Add,
+	Cancel,
+	Modify,
+	AdvanceClock,
+	CancelSide,    // every resting order and pending stop on side_
+	CancelRange,   // every resting order on side_ priced within [price_, stopPrice_]
+	CancelOwner    // every resting order and pending stop entered under owner_; never owner 0 (untagged), which throws
+};
+
+// Fixed-size, trivially copyable order-entry message: what gateways hand to the engine.
+// symbol_ picks the book; Modify keeps the order's type, so orderType_ is only read for Add.
+// AdvanceClock carries the book's new time in price_, so the clock is journaled like any command.
+// stopPrice_ is only read for Stop and StopLimit adds, and as the top of a CancelRange band.
+// owner_ tags an Add and selects the orders of a CancelOwner.
+// Journals and order files store commands byte for byte, so every factory starts from an all-zero
+// command and the padding after type_ is always 0.
+struct Command {
+    CommandType type_{CommandType::Add};
+    Side side_{Side::BID};
+    OrderType orderType_{OrderType::GoodTillCancel};
+    Symbol symbol_{0};
+    Quantity quantity_{0};
+    Owner owner_{0};
+    OrderId orderId_{0};
+    Price price_{0};
+    std::int64_t enqueuedAt_{0};
+    Price stopPrice_{0};
+
+    static Command Zeroed() {
+        Command command;
+        std::memset(static_cast<void*>(&command), 0, sizeof(command));
+        return command;
+    }
+
+    static Command Add(const Order& order, Symbol symbol = 0) {
+        Command command = Zeroed();
+        command.type_ = CommandType::Add;
+        command.side_ = order.GetSide();
+        command.orderType_ = order.GetOrderType();
+        command.symbol_ = symbol;
+        command.quantity_ = order.GetRemainingQuantity();
+        command.owner_ = order.GetOwner();
+        command.orderId_ = order.GetOrderId();
+        command.price_ = order.GetPrice();
+        command.stopPrice_ = order.GetStopPrice();
+        return command;
+    }
+
+    static Command Cancel(OrderId orderId, Symbol symbol = 0) {
+        Command command = Zeroed();
+        command.type_ = CommandType::Cancel;
+        command.symbol_ = symbol;
+        command.orderId_ = orderId;
+        return command;
+    }
+
+    static Command Modify(OrderId orderId, Price price, Quantity quantity, Side side, Symbol symbol = 0) {
+        Command command = Zeroed();
+        command.type_ = CommandType::Modify;
+        command.side_ = side;
+        command.symbol_ = symbol;
+        command.quantity_ = quantity;
+        command.orderId_ = orderId;
+        command.price_ = price;
+        return command;
+    }
+
+    static Command AdvanceClock(Timestamp now, Symbol symbol = 0) {
+        Command command = Zeroed();
+        command.type_ = CommandType::AdvanceClock;
+        command.symbol_ = symbol;
+        command.price_ = now;
+        return command;
+    }
+
+    static Command CancelSide(Side side, Symbol symbol = 0) {
+        Command command = Zeroed();
+        command.type_ = CommandType::CancelSide;
+        command.side_ = side;
+        command.symbol_ = symbol;
+        return command;
+    }
+
+    static Command CancelRange(Side side, Price low, Price high, Symbol symbol = 0) {
+        Command command = Zeroed();
+        command.type_ = CommandType::CancelRange;
+        command.side_ = side;
+        command.symbol_ = symbol;
+        command.price_ = low;
+        command.stopPrice_ = high;
+        return command;
+    }
+
+    static Command CancelOwner(Owner owner, Symbol symbol = 0) {
+        Command command = Zeroed();
+        command.type_ = CommandType::CancelOwner;
+        command.symbol_ = symbol;
+        command.owner_ = owner;
+        return command;
+    }
+
+    Order ToOrder() const { return Order(orderId_, price_, quantity_, side_, orderType_, stopPrice_, owner_); }
+    OrderModify ToOrderModify() const { return OrderModify(orderId_, price_, quantity_, side_); }
+};
+
+// Monotonic nanoseconds used to stamp commands when they are enqueued
+inline std::int64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "MatchingEngine.h"
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct ExchangeConfig {
+    std::size_t shards_{1};
+    bool pinThreads_{false};
+    int firstCpu_{0};   // shard i is pinned to firstCpu_ + i when pinThreads_ is set
+    EngineConfig engine_{};
+};
+
+// Multi-instrument front end: one OrderBook per symbol, with symbols spread over a pool of
+// MatchingEngine shards. Each shard is its own single-writer thread with its own lock-free
+// inbound ring, so shards never share a book, a queue or a lock and throughput grows with
+// the number of cores given to them.
+// Symbols are placed on the shard with the least expected load so far; pass a weight
+// (e.g. typical messages/sec) to AddSymbol to keep hot names from piling onto one core.
+class Exchange {
+private:
+    static constexpr std::uint32_t kNoShard = static_cast<std::uint32_t>(-1);
+
+    ExchangeConfig config_;
+    std::vector<std::unique_ptr<MatchingEngine>> shards_;
+    std::vector<double> shardLoad_;
+    std::vector<std::uint32_t> shardOf_;   // symbol -> shard
+
+public:
+    explicit Exchange(ExchangeConfig config = {})
+        : config_{ config }
+        , shardLoad_(config.shards_, 0.0)
+    {
+        if (config.shards_ == 0) throw std::invalid_argument("Exchange needs at least one shard");
+        for (std::size_t i = 0; i < config.shards_; ++i) {
+            EngineConfig engine = config.engine_;
+            engine.cpu_ = config.pinThreads_ ? config.firstCpu_ + static_cast<int>(i) : -1;
+            shards_.push_back(std::make_unique<MatchingEngine>(engine, MatchingEngine::NoBooks{}));
+        }
+    }
+
+    // Not thread-safe: all symbols must be listed before Start
+    void AddSymbol(Symbol symbol, OrderBook book = {}, double weight = 1.0) {
+        if (symbol < shardOf_.size() && shardOf_[symbol] != kNoShard)
+            throw std::invalid_argument("Symbol already listed");
+
+        std::size_t shard = 0;
+        for (std::size_t i = 1; i < shardLoad_.size(); ++i)
+            if (shardLoad_[i] < shardLoad_[shard]) shard = i;
+
+        shards_[shard]->AddBook(symbol, std::move(book));
+        shardLoad_[shard] += weight;
+        if (symbol >= shardOf_.size()) shardOf_.resize(symbol + 1, kNoShard);
+        shardOf_[symbol] = static_cast<std::uint32_t>(shard);
+    }
+
+    // Not thread-safe: set before Start. Each shard records as "shard.<i>".
+    void SetMetrics(MetricsRegistry* registry) {
+        for (std::size_t i = 0; i < shards_.size(); ++i) shards_[i]->SetMetrics(registry, "shard." + std::to_string(i));
+    }
+
+    void Start() {
+        for (auto& shard : shards_) shard->Start();
+    }
+
+    void Stop() {
+        for (auto& shard : shards_) shard->Stop();
+    }
+
+    // Thread-safe; routes the command to the shard that owns its symbol
+    bool Submit(const Command& command) {
+        if (command.symbol_ >= shardOf_.size() || shardOf_[command.symbol_] == kNoShard)
+            throw std::out_of_range("Unknown symbol");
+        return shards_[shardOf_[command.symbol_]]->Submit(command);
+    }
+
+    std::size_t ShardCount() const { return shards_.size(); }
+    std::size_t ShardOf(Symbol symbol) const { return shardOf_.at(symbol); }
+    MatchingEngine& GetShard(std::size_t shard) { return *shards_.at(shard); }
+    const MatchingEngine& GetShard(std::size_t shard) const { return *shards_.at(shard); }
+
+    const MatchingEngine& GetEngineFor(Symbol symbol) const { return *shards_[ShardOf(symbol)]; }
+
+    // Sum over shards; latency max is the worst shard, mean is weighted by commands processed
+    EngineStats GetStats() const {
+        EngineStats total;
+        std::uint64_t latencySum = 0;
+        for (const auto& shard : shards_) {
+            auto stats = shard->GetStats();
+            total.commandsProcessed_ += stats.commandsProcessed_;
+            total.commandsRejected_ += stats.commandsRejected_;
+            total.producerRejects_ += stats.producerRejects_;
+            total.eventsDropped_ += stats.eventsDropped_;
+            total.queueDepth_ += stats.queueDepth_;
+            total.maxLatencyNanos_ = std::max(total.maxLatencyNanos_, stats.maxLatencyNanos_);
+            latencySum += stats.meanLatencyNanos_ * stats.commandsProcessed_;
+        }
+        total.meanLatencyNanos_ = total.commandsProcessed_ ? latencySum / total.commandsProcessed_ : 0;
+        return total;
+    }
+};
@@ -0,0 +1,527 @@
+#pragma once
+#include "Command.h"
+#include "orderbook.h"
+#include "using.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Durable command log plus checkpoints, so resting state survives a restart.
+//
+// Journal: every inbound command gets the next sequence number and is appended as a fixed-size
+// record to a memory-mapped, preallocated segment file (journal.<first sequence>.log). Appending
+// is a memcpy into the mapping; a background committer makes everything appended since its last
+// pass durable with one msync per interval (group commit), so the caller never waits on the disk.
+// The committer also preallocates the next segment, so rolling over costs the writer a rename.
+//
+// Checkpoint: a compact image of every book (each resting order in priority order) tagged with the
+// last journal sequence it includes (checkpoint.<sequence>.bin, written to a temp file and renamed).
+//
+// Recovery loads the newest checkpoint and replays the journal records after it through
+// OrderBook::Apply, the same path the engine uses, which rebuilds the books exactly.
+
+// Leads every record. Journals from before it start with a bare sequence number and are refused,
+// since their commands do not have today's layout.
+constexpr std::uint64_t kJournalMagic = 0x32304C4E524A424Full;   // "OBJRNL02"
+
+struct JournalRecord {
+    std::uint64_t magic_;
+    std::uint64_t sequence_;
+    Command command_;
+    std::uint64_t checksum_;
+};
+
+static_assert(std::is_trivially_copyable_v<JournalRecord>);
+static_assert(sizeof(JournalRecord) == 80);
+
+inline std::uint64_t JournalChecksum(const JournalRecord& record) {
+    // FNV-1a over everything before the checksum; a torn or unwritten record fails it
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&record);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < offsetof(JournalRecord, checksum_); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash | 1;   // never 0, so a zero-filled record is never valid
+}
+
+struct JournalConfig {
+    std::string directory_;
+    std::size_t segmentRecords_{1 << 20};
+    std::chrono::microseconds commitInterval_{1000};
+};
+
+inline std::filesystem::path JournalSegmentPath(const std::string& directory, std::uint64_t firstSequence) {
+    return std::filesystem::path(directory) / std::format("journal.{:020}.log", firstSequence);
+}
+
+inline std::filesystem::path CheckpointPath(const std::string& directory, std::uint64_t sequence) {
+    return std::filesystem::path(directory) / std::format("checkpoint.{:020}.bin", sequence);
+}
+
+// Files named <prefix>.<sequence><suffix> in directory, oldest first
+inline std::vector<std::pair<std::uint64_t, std::filesystem::path>> ListSequencedFiles(const std::string& directory, std::string_view prefix, std::string_view suffix) {
+    std::vector<std::pair<std::uint64_t, std::filesystem::path>> files;
+    if (!std::filesystem::exists(directory)) return files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() + suffix.size() || !name.starts_with(prefix) || !name.ends_with(suffix)) continue;
+        std::string number = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        if (number.empty() || !std::all_of(number.begin(), number.end(), [](char c) { return c >= '0' && c <= '9'; })) continue;
+        files.emplace_back(std::stoull(number), entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+inline void SyncDirectory(const std::string& directory) {
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+}
+
+// Read-only mapping of a whole file
+class MappedFile {
+private:
+    int fd_{-1};
+    void* data_{nullptr};
+    std::size_t size_{0};
+
+public:
+    explicit MappedFile(const std::filesystem::path& path) {
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "open " + path.string());
+        struct stat info;
+        fstat(fd_, &info);
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ == 0) return;
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data_ == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap " + path.string());
+        madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+
+    ~MappedFile() {
+        if (data_ && data_ != MAP_FAILED) munmap(data_, size_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::byte* Data() const { return static_cast<const std::byte*>(data_); }
+    std::size_t Size() const { return size_; }
+};
+
+// Single writer (the engine thread); the committer runs on its own thread
+class Journal {
+private:
+    struct Segment {
+        int fd_{-1};
+        JournalRecord* records_{nullptr};
+        std::size_t capacity_{0};
+        std::uint64_t firstSequence_{0};
+        std::atomic<std::size_t> written_{0};   // published by the writer
+        std::size_t synced_{0};                 // committer only
+        std::filesystem::path path_;
+
+        ~Segment() {
+            if (records_) munmap(records_, capacity_ * sizeof(JournalRecord));
+            if (fd_ >= 0) close(fd_);
+        }
+    };
+
+    JournalConfig config_;
+    std::shared_ptr<Segment> current_;
+    std::vector<std::shared_ptr<Segment>> sealed_;   // full segments the committer still has to sync
+    std::shared_ptr<Segment> standby_;               // preallocated by the committer for the next roll
+    bool renamed_{false};                            // a segment was renamed since the directory was synced
+    std::uint64_t standbyCount_{0};
+    std::mutex segmentsMutex_;
+    std::uint64_t sequence_{0};
+
+    alignas(64) std::atomic<std::uint64_t> durable_{0};
+    std::atomic<bool> running_{false};
+    std::thread committer_;
+
+    std::shared_ptr<Segment> OpenSegment(const std::filesystem::path& path, std::uint64_t firstSequence) {
+        auto segment = std::make_shared<Segment>();
+        segment->path_ = path;
+        std::size_t bytes = config_.segmentRecords_ * sizeof(JournalRecord);
+        segment->fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (segment->fd_ < 0) throw std::system_error(errno, std::generic_category(), "open " + path.string());
+        if (ftruncate(segment->fd_, static_cast<off_t>(bytes)) < 0)
+            throw std::system_error(errno, std::generic_category(), "ftruncate " + path.string());
+        int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;   // take the page faults now rather than on the append path
+#endif
+        void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, segment->fd_, 0);
+        if (data == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap " + path.string());
+        segment->records_ = static_cast<JournalRecord*>(data);
+        segment->capacity_ = config_.segmentRecords_;
+        segment->firstSequence_ = firstSequence;
+        SyncDirectory(config_.directory_);
+        return segment;
+    }
+
+    // Makes records [synced_, upTo) of a segment durable; returns the last sequence covered
+    static std::uint64_t Sync(Segment& segment, std::size_t upTo) {
+        if (upTo > segment.synced_) {
+            static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            auto begin = reinterpret_cast<std::uintptr_t>(segment.records_ + segment.synced_) & ~(page - 1);
+            auto end = reinterpret_cast<std::uintptr_t>(segment.records_ + upTo);
+            msync(reinterpret_cast<void*>(begin), end - begin, MS_SYNC);
+            segment.synced_ = upTo;
+        }
+        return segment.firstSequence_ + segment.synced_ - 1;
+    }
+
+    // Rolls to the standby segment if the committer has one ready, so the append path normally
+    // pays only for a rename; falls back to creating the segment inline
+    std::shared_ptr<Segment> NextSegment() {
+        std::uint64_t firstSequence = sequence_ + 1;
+        auto path = JournalSegmentPath(config_.directory_, firstSequence);
+        {
+            std::lock_guard<std::mutex> lock(segmentsMutex_);
+            if (standby_) {
+                auto next = std::move(standby_);
+                std::filesystem::rename(next->path_, path);
+                next->path_ = path;
+                next->firstSequence_ = firstSequence;
+                renamed_ = true;
+                return next;
+            }
+        }
+        return OpenSegment(path, firstSequence);
+    }
+
+    void Commit() {
+        std::vector<std::shared_ptr<Segment>> sealed;
+        std::shared_ptr<Segment> current;
+        bool renamed;
+        bool needStandby;
+        {
+            std::lock_guard<std::mutex> lock(segmentsMutex_);
+            sealed.swap(sealed_);
+            current = current_;
+            renamed = std::exchange(renamed_, false);
+            needStandby = !standby_;
+        }
+        if (renamed) SyncDirectory(config_.directory_);
+        std::uint64_t durable = durable_.load(std::memory_order_relaxed);
+        for (auto& segment : sealed)
+            durable = std::max(durable, Sync(*segment, segment->written_.load(std::memory_order_acquire)));
+        std::size_t written = current->written_.load(std::memory_order_acquire);
+        if (written > 0) durable = std::max(durable, Sync(*current, written));
+        durable_.store(durable, std::memory_order_release);
+
+        if (needStandby && running_.load(std::memory_order_relaxed)) {
+            auto path = std::filesystem::path(config_.directory_) / std::format("journal.standby.{}.tmp", ++standbyCount_);
+            auto standby = OpenSegment(path, 0);
+            std::lock_guard<std::mutex> lock(segmentsMutex_);
+            standby_ = std::move(standby);
+        }
+    }
+
+    void RunCommitter() {
+        while (running_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(config_.commitInterval_);
+            Commit();
+        }
+        Commit();
+    }
+
+public:
+    // Appends continue from nextSequence; pass Recovery's sequence_ + 1 after a restart
+    explicit Journal(JournalConfig config, std::uint64_t nextSequence = 1)
+        : config_{ std::move(config) }
+        , sequence_{ nextSequence - 1 }
+        , durable_{ nextSequence - 1 }
+    {
+        if (config_.segmentRecords_ == 0) throw std::invalid_argument("Journal segments must hold at least one record");
+        std::filesystem::create_directories(config_.directory_);
+        // anything at or past nextSequence was not recovered and must not be replayed later
+        for (const auto& [first, path] : ListSequencedFiles(config_.directory_, "journal.", ".log"))
+            if (first >= nextSequence) std::filesystem::remove(path);
+        for (const auto& [count, path] : ListSequencedFiles(config_.directory_, "journal.standby.", ".tmp"))
+            std::filesystem::remove(path);
+        current_ = OpenSegment(JournalSegmentPath(config_.directory_, nextSequence), nextSequence);
+        running_ = true;
+        committer_ = std::thread([this] { RunCommitter(); });
+    }
+
+    ~Journal() {
+        running_.store(false, std::memory_order_release);
+        if (committer_.joinable()) committer_.join();
+        if (standby_) std::filesystem::remove(standby_->path_);
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Writer thread only. Never blocks on the disk; only rolling to a new segment touches the filesystem.
+    std::uint64_t Append(const Command& command) {
+        Segment* segment = current_.get();
+        std::size_t slot = segment->written_.load(std::memory_order_relaxed);
+        if (slot == segment->capacity_) {
+            auto next = NextSegment();
+            std::lock_guard<std::mutex> lock(segmentsMutex_);
+            sealed_.push_back(std::move(current_));
+            current_ = std::move(next);
+            segment = current_.get();
+            slot = 0;
+        }
+        JournalRecord record;
+        std::memset(static_cast<void*>(&record), 0, sizeof(record));
+        record.magic_ = kJournalMagic;
+        record.sequence_ = ++sequence_;
+        std::memcpy(&record.command_, &command, sizeof(command));   // padding and all, as the checksum sees it
+        record.checksum_ = JournalChecksum(record);
+        std::memcpy(&segment->records_[slot], &record, sizeof(record));
+        segment->written_.store(slot + 1, std::memory_order_release);
+        return sequence_;
+    }
+
+    // Writer thread only: last sequence appended
+    std::uint64_t GetSequence() const { return sequence_; }
+
+    // Any thread: every record up to this sequence is on disk
+    std::uint64_t GetDurableSequence() const { return durable_.load(std::memory_order_acquire); }
+
+    // Any thread: waits for the committer to cover sequence
+    void WaitDurable(std::uint64_t sequence) const {
+        while (GetDurableSequence() < sequence) std::this_thread::yield();
+    }
+
+    // Writer thread only: deletes segments whose records all precede sequence (already in a checkpoint)
+    void ReleaseBefore(std::uint64_t sequence) {
+        auto segments = ListSequencedFiles(config_.directory_, "journal.", ".log");
+        for (std::size_t i = 0; i + 1 < segments.size(); ++i) {
+            if (segments[i + 1].first > sequence || segments[i].first == current_->firstSequence_) break;
+            std::filesystem::remove(segments[i].second);
+        }
+    }
+
+    const std::string& GetDirectory() const { return config_.directory_; }
+};
+
+// Checkpoint file layout, all little-endian, fixed width
+struct CheckpointHeader {
+    std::uint64_t magic_;
+    std::uint64_t sequence_;   // last journal record included
+    std::uint64_t bookCount_;
+};
+
+struct CheckpointBookHeader {
+    Symbol symbol_;
+    std::uint32_t dense_;
+    LadderConfig ladder_;
+    SessionSchedule session_;
+    Timestamp clock_;
+    std::uint64_t levelSequence_;   // the book's L2 delta sequence
+    std::uint64_t orderCount_;      // resting orders and pending stops
+    Price lastPrice_;               // what pending stops trigger on; valid when hasLastPrice_
+    std::uint64_t hasLastPrice_;
+};
+
+struct CheckpointOrder {
+    OrderId orderId_;
+    Price price_;
+    Price stopPrice_;
+    Quantity initialQuantity_;
+    Quantity remainingQuantity_;
+    std::uint8_t side_;
+    std::uint8_t orderType_;
+    std::uint16_t padding_;
+    Owner owner_;   // written as 0 before owners existed, which is untagged
+};
+
+static_assert(sizeof(CheckpointOrder) == 40);
+
+constexpr std::uint64_t kCheckpointMagic = 0x33304B43424B424Full;   // "OBKBCK03"
+
+using SymbolBooks = std::vector<std::pair<Symbol, OrderBook>>;
+template <OrderListener Listener = NullOrderListener>
+using BasicSymbolBookRefs = std::vector<std::pair<Symbol, const BasicOrderBook<Listener>*>>;
+using SymbolBookRefs = BasicSymbolBookRefs<>;
+
+// Writes a checkpoint of books as of journal sequence; cost is O(resting orders)
+template <OrderListener Listener>
+void WriteCheckpoint(const std::string& directory, std::uint64_t sequence, const BasicSymbolBookRefs<Listener>& books) {
+    auto path = CheckpointPath(directory, sequence);
+    auto temp = path;
+    temp += ".tmp";
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + temp.string());
+
+    std::vector<std::byte> buffer;
+    buffer.reserve(1 << 20);
+    auto flush = [&] {
+        std::size_t offset = 0;
+        while (offset < buffer.size()) {
+            ssize_t n = write(fd, buffer.data() + offset, buffer.size() - offset);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "write " + temp.string());
+            }
+            offset += static_cast<std::size_t>(n);
+        }
+        buffer.clear();
+    };
+    auto put = [&](const auto& value) {
+        const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+        if (buffer.size() >= (1 << 20)) flush();
+    };
+
+    put(CheckpointHeader{ kCheckpointMagic, sequence, books.size() });
+    for (const auto& [symbol, book] : books) {
+        auto ladder = book->GetLadderConfig();
+        put(CheckpointBookHeader{ symbol, ladder.has_value(), ladder.value_or(LadderConfig{ 0, 1, 0 }),
+                                     book->GetSessionSchedule(), book->GetClock(), book->GetSequence(), book->Size(),
+                                     book->GetLastPrice().value_or(0), book->GetLastPrice().has_value() });
+        book->ForEachOrder([&](const Order& order) {
+            put(CheckpointOrder{ order.GetOrderId(), order.GetPrice(), order.GetStopPrice(), order.GetInitialQuantity(), order.GetRemainingQuantity(),
+                                 static_cast<std::uint8_t>(order.GetSide()), static_cast<std::uint8_t>(order.GetOrderType()), 0, order.GetOwner() });
+        });
+    }
+    flush();
+    fsync(fd);
+    close(fd);
+    std::filesystem::rename(temp, path);
+    SyncDirectory(directory);
+
+    // keep only the newest checkpoint
+    for (const auto& [older, olderPath] : ListSequencedFiles(directory, "checkpoint.", ".bin"))
+        if (older < sequence) std::filesystem::remove(olderPath);
+}
+
+inline void WriteCheckpoint(const std::string& directory, std::uint64_t sequence, const SymbolBookRefs& books) {
+    WriteCheckpoint<NullOrderListener>(directory, sequence, books);
+}
+
+// Calls f(record) for each journal record after sequence `after`, in order. Stops at the first
+// missing, torn or out-of-sequence record; returns the sequence of the last record delivered.
+// Throws on a segment written in an older record format rather than replay it as garbage.
+template <typename F>
+std::uint64_t ReadJournal(const std::string& directory, std::uint64_t after, F&& f) {
+    auto segments = ListSequencedFiles(directory, "journal.", ".log");
+    for (std::size_t s = 0; s < segments.size(); ++s) {
+        if (s + 1 < segments.size() && segments[s + 1].first <= after + 1) continue;   // wholly before after
+        if (segments[s].first > after + 1) break;   // gap in the log
+        MappedFile file{ segments[s].second };
+        std::size_t count = file.Size() / sizeof(JournalRecord);
+        for (std::size_t i = 0; i < count; ++i) {
+            JournalRecord record;
+            std::memcpy(&record, file.Data() + i * sizeof(JournalRecord), sizeof(record));
+            if (i == 0 && record.magic_ != kJournalMagic && record.magic_ != 0)
+                throw std::runtime_error(std::format("{} was written in an older journal format; recover it with the build that wrote it.", segments[s].second.string()));
+            if (record.magic_ != kJournalMagic || record.checksum_ != JournalChecksum(record)) break;
+            if (record.sequence_ <= after) continue;
+            if (record.sequence_ != after + 1) break;
+            f(record);
+            after = record.sequence_;
+        }
+    }
+    return after;
+}
+
+struct RecoveryResult {
+    std::uint64_t sequence_{0};            // last journal record applied; append from sequence_ + 1
+    std::uint64_t checkpointSequence_{0};  // 0 when there was no checkpoint
+    std::uint64_t replayed_{0};            // journal records applied on top of the checkpoint
+    std::size_t restoredOrders_{0};
+};
+
+// Reads back what WriteCheckpoint wrote
+inline SymbolBooks LoadCheckpoint(const std::filesystem::path& path, std::size_t& restoredOrders) {
+    MappedFile file{ path };
+    const std::byte* cursor = file.Data();
+    const std::byte* end = cursor + file.Size();
+    auto take = [&]<typename T>(T& value) {
+        if (static_cast<std::size_t>(end - cursor) < sizeof(T))
+            throw std::runtime_error(std::format("Checkpoint {} is truncated.", path.string()));
+        std::memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+    };
+
+    CheckpointHeader header;
+    take(header);
+    if (header.magic_ != kCheckpointMagic)
+        throw std::runtime_error(std::format("{} is not a checkpoint.", path.string()));
+
+    SymbolBooks books;
+    for (std::uint64_t b = 0; b < header.bookCount_; ++b) {
+        CheckpointBookHeader bookHeader;
+        take(bookHeader);
+        OrderBook book = bookHeader.dense_ ? OrderBook{ bookHeader.ladder_ } : OrderBook{};
+        book.ReserveOrders(bookHeader.orderCount_);
+        book.SetSessionSchedule(bookHeader.session_);
+        book.AdvanceClock(bookHeader.clock_);
+        for (std::uint64_t i = 0; i < bookHeader.orderCount_; ++i) {
+            CheckpointOrder order;
+            take(order);
+            Order restored(order.orderId_, order.price_, order.initialQuantity_, static_cast<Side>(order.side_), static_cast<OrderType>(order.orderType_), order.stopPrice_, order.owner_);
+            restored.FillOrder(order.initialQuantity_ - order.remainingQuantity_);
+            book.RestoreOrder(restored);
+        }
+        book.RestoreSequence(bookHeader.levelSequence_);
+        if (bookHeader.hasLastPrice_) book.RestoreLastPrice(bookHeader.lastPrice_);
+        restoredOrders += bookHeader.orderCount_;
+        books.emplace_back(bookHeader.symbol_, std::move(book));
+    }
+    return books;
+}
+
+// Rebuilds books from directory. books holds the books to recover into (as created on a cold
+// start); a checkpoint replaces them wholesale, then every journal record after it is replayed.
+inline RecoveryResult Recover(const std::string& directory, SymbolBooks& books) {
+    RecoveryResult result;
+    auto checkpoints = ListSequencedFiles(directory, "checkpoint.", ".bin");
+    if (!checkpoints.empty()) {
+        books = LoadCheckpoint(checkpoints.back().second, result.restoredOrders_);
+        result.checkpointSequence_ = result.sequence_ = checkpoints.back().first;
+    }
+
+    std::vector<std::pair<Symbol, OrderBook*>> index;
+    for (auto& [symbol, book] : books) index.emplace_back(symbol, &book);
+    std::sort(index.begin(), index.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    auto find = [&](Symbol symbol) -> OrderBook* {
+        auto it = std::lower_bound(index.begin(), index.end(), symbol, [](const auto& entry, Symbol s) { return entry.first < s; });
+        return it != index.end() && it->first == symbol ? it->second : nullptr;
+    };
+
+    result.sequence_ = ReadJournal(directory, result.sequence_, [&](const JournalRecord& record) {
+        if (OrderBook* book = find(record.command_.symbol_)) {
+            try {
+                book->Apply(record.command_);
+            } catch (const std::exception&) {
+                // rejected live as well
+            }
+        }
+        ++result.replayed_;
+    });
+    return result;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "Trade.h"
+#include "using.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+// New aggregate quantity at one price; quantity_ == 0 means the level is gone.
+// sequence_ is per book and increases by one for every update the book emits.
+struct LevelUpdate {
+    Price price_{0};
+    Quantity quantity_{0};
+    Side side_{Side::BID};
+    std::uint64_t sequence_{0};
+};
+
+using LevelUpdates = std::vector<LevelUpdate>;
+
+// Full-depth view of a book as of update sequence_: applying every update with a larger
+// sequence number to it reproduces the book
+struct L2Snapshot {
+    std::uint64_t sequence_{0};
+    LevelInfos bids_;
+    LevelInfos asks_;
+};
+
+// Downstream replica of a book kept from a snapshot plus the delta stream.
+// Apply returns false on a sequence gap, after which the replica must be Reset from a new snapshot.
+class L2Book {
+private:
+    std::map<Price, Quantity, std::greater<Price>> bids_;
+    std::map<Price, Quantity, std::less<Price>> asks_;
+    std::uint64_t sequence_{0};
+    bool synced_{false};
+
+    template <typename Levels>
+    static LevelInfos Top(const Levels& levels, std::size_t count) {
+        LevelInfos result;
+        for (const auto& [price, quantity] : levels) {
+            if (result.size() >= count) break;
+            result.push_back({price, quantity});
+        }
+        return result;
+    }
+
+public:
+    void Reset(const L2Snapshot& snapshot) {
+        bids_.clear();
+        asks_.clear();
+        for (const auto& level : snapshot.bids_) bids_[level.price_] = level.quantity_;
+        for (const auto& level : snapshot.asks_) asks_[level.price_] = level.quantity_;
+        sequence_ = snapshot.sequence_;
+        synced_ = true;
+    }
+
+    bool Apply(const LevelUpdate& update) {
+        if (!synced_) return false;
+        if (update.sequence_ <= sequence_) return true;   // already covered by the snapshot
+        if (update.sequence_ != sequence_ + 1) {
+            synced_ = false;
+            return false;
+        }
+        sequence_ = update.sequence_;
+        if (update.side_ == Side::BID) {
+            if (update.quantity_ == 0) bids_.erase(update.price_);
+            else bids_[update.price_] = update.quantity_;
+        } else {
+            if (update.quantity_ == 0) asks_.erase(update.price_);
+            else asks_[update.price_] = update.quantity_;
+        }
+        return true;
+    }
+
+    bool IsSynced() const { return synced_; }
+    bool IsCrossed() const { return !bids_.empty() && !asks_.empty() && bids_.begin()->first >= asks_.begin()->first; }
+    std::uint64_t GetSequence() const { return sequence_; }
+    LevelInfos GetBids(std::size_t levels) const { return Top(bids_, levels); }
+    LevelInfos GetAsks(std::size_t levels) const { return Top(asks_, levels); }
+};
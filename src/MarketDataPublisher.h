@@ -0,0 +1,374 @@
+#pragma once
+#include "MatchingEngine.h"
+#include "WireFormat.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+enum class Transport
+{
+	Unix,
+	Tcp
+};
+
+struct PublisherConfig {
+    Transport transport_{Transport::Unix};
+    std::string path_{"/tmp/orderbook-md.sock"};   // Unix domain socket path
+    std::uint16_t port_{0};                        // loopback TCP port, 0 picks a free one
+    std::size_t maxBatchBytes_{16 * 1024};         // a batch is flushed when full or when the engine ring runs dry
+    std::size_t clientQueueBytes_{4 * 1024 * 1024};   // per-subscriber backlog before batches are dropped for it
+    std::size_t maxDroppedBatches_{256};           // consecutive drops before a slow subscriber is disconnected, 0 = never
+    int cpu_{-1};
+};
+
+// Counters the publisher thread publishes for monitoring; readable from any thread
+struct PublisherStats {
+    std::size_t clients_{0};
+    std::uint64_t batches_{0};
+    std::uint64_t messages_{0};
+    std::uint64_t bytesSent_{0};
+    std::uint64_t batchesDropped_{0};
+    std::uint64_t slowConsumersDisconnected_{0};
+};
+
+// Streams an engine's outbound events to any number of local subscribers in the binary wire format.
+// The publisher thread is the engine's single outbound consumer. Events are encoded straight into
+// the current batch buffer; a flushed batch is immutable and shared by every subscriber's queue,
+// so fan-out costs one encode and one reference per subscriber, never a copy. Each subscriber has
+// a bounded queue drained with non-blocking vectored writes: a batch that does not fit is dropped
+// for that subscriber only (it sees a batchSequence_ gap), and a subscriber that keeps falling
+// behind is disconnected. The engine is never slowed down by a subscriber.
+class MarketDataPublisher {
+private:
+    struct Batch {
+        std::vector<std::byte> bytes_;
+    };
+    using BatchPointer = std::shared_ptr<const Batch>;
+
+    struct Client {
+        int fd_;
+        std::deque<BatchPointer> queue_;
+        std::size_t offset_{0};        // bytes of queue_.front() already written
+        std::size_t queuedBytes_{0};
+        std::size_t droppedBatches_{0};
+
+        explicit Client(int fd) : fd_{ fd } { }
+    };
+
+    static constexpr int kMaxIovecs = 64;
+
+    MatchingEngine& engine_;
+    PublisherConfig config_;
+    int listenFd_{-1};
+    std::uint16_t port_{0};
+    std::vector<Client> clients_;
+    std::shared_ptr<Batch> current_;
+    std::uint32_t currentCount_{0};
+    std::vector<std::shared_ptr<Batch>> spare_;
+    std::deque<std::shared_ptr<Batch>> inFlight_;
+    std::uint64_t batchSequence_{0};
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    // written by the publisher thread only
+    std::atomic<std::size_t> clientCount_{0};
+    std::atomic<std::uint64_t> batches_{0};
+    std::atomic<std::uint64_t> messages_{0};
+    std::atomic<std::uint64_t> bytesSent_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> disconnected_{0};
+
+    static void Bump(std::atomic<std::uint64_t>& counter, std::uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    static void SetNonBlocking(int fd) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    void Listen() {
+        if (config_.transport_ == Transport::Unix) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (config_.path_.size() >= sizeof(address.sun_path)) throw std::invalid_argument("Socket path too long");
+            std::memcpy(address.sun_path, config_.path_.c_str(), config_.path_.size() + 1);
+            listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listenFd_ < 0) throw std::system_error(errno, std::generic_category(), "socket");
+            unlink(config_.path_.c_str());
+            if (bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+                throw std::system_error(errno, std::generic_category(), "bind " + config_.path_);
+        } else {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(config_.port_);
+            listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+            if (listenFd_ < 0) throw std::system_error(errno, std::generic_category(), "socket");
+            int one = 1;
+            setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+                throw std::system_error(errno, std::generic_category(), "bind");
+            socklen_t length = sizeof(address);
+            getsockname(listenFd_, reinterpret_cast<sockaddr*>(&address), &length);
+            port_ = ntohs(address.sin_port);
+        }
+        if (listen(listenFd_, SOMAXCONN) < 0) throw std::system_error(errno, std::generic_category(), "listen");
+        SetNonBlocking(listenFd_);
+    }
+
+    void AcceptClients() {
+        while (true) {
+            int fd = accept(listenFd_, nullptr, nullptr);
+            if (fd < 0) break;
+            SetNonBlocking(fd);
+            if (config_.transport_ == Transport::Tcp) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            clients_.emplace_back(fd);
+        }
+        clientCount_.store(clients_.size(), std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<Batch> NewBatch() {
+        std::shared_ptr<Batch> batch;
+        if (spare_.empty()) {
+            batch = std::make_shared<Batch>();
+            batch->bytes_.reserve(config_.maxBatchBytes_ + kMaxMessageSize);
+        } else {
+            batch = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        batch->bytes_.resize(sizeof(BatchHeader));
+        return batch;
+    }
+
+    // Batches no subscriber references any more go back to the spare list
+    void RecycleBatches() {
+        while (!inFlight_.empty() && inFlight_.front().use_count() == 1) {
+            spare_.push_back(std::move(inFlight_.front()));
+            inFlight_.pop_front();
+        }
+    }
+
+    template <typename Message>
+    void Append(const Message& message) {
+        if (current_->bytes_.size() + sizeof(Message) > config_.maxBatchBytes_ && currentCount_ > 0) Flush();
+        auto& bytes = current_->bytes_;
+        std::size_t offset = bytes.size();
+        bytes.resize(offset + sizeof(Message));
+        std::memcpy(bytes.data() + offset, &message, sizeof(Message));
+        ++currentCount_;
+    }
+
+    void Encode(const EngineEvent& event) {
+        switch (event.type_) {
+        case EngineEventType::Trade: {
+            auto message = MakeMessage<TradeMessage>(MessageType::Trade, event.symbol_);
+            message.bidOrderId_ = event.trade_.GetBidOrderId();
+            message.askOrderId_ = event.trade_.GetAskOrderId();
+            message.bidPrice_ = event.trade_.GetBidPrice();
+            message.askPrice_ = event.trade_.GetAskPrice();
+            message.quantity_ = event.trade_.GetQuantity();
+            message.aggressor_ = static_cast<std::uint8_t>(event.trade_.GetAggressor());
+            Append(message);
+            break;
+        }
+        case EngineEventType::TopOfBook: {
+            auto message = MakeMessage<TopOfBookMessage>(MessageType::TopOfBook, event.symbol_);
+            message.bidPrice_ = event.bestBid_.price_;
+            message.askPrice_ = event.bestAsk_.price_;
+            message.bidQuantity_ = event.bestBid_.quantity_;
+            message.askQuantity_ = event.bestAsk_.quantity_;
+            Append(message);
+            break;
+        }
+        case EngineEventType::LevelUpdate:
+        case EngineEventType::SnapshotLevel: {
+            auto type = event.type_ == EngineEventType::LevelUpdate ? MessageType::LevelUpdate : MessageType::SnapshotLevel;
+            auto message = MakeMessage<LevelMessage>(type, event.symbol_, static_cast<std::uint8_t>(event.level_.side_));
+            message.price_ = event.level_.price_;
+            message.sequence_ = event.level_.sequence_;
+            message.quantity_ = event.level_.quantity_;
+            Append(message);
+            break;
+        }
+        case EngineEventType::SnapshotBegin: {
+            auto message = MakeMessage<SnapshotBeginMessage>(MessageType::SnapshotBegin, event.symbol_);
+            message.sequence_ = event.level_.sequence_;
+            message.levelCount_ = event.count_;
+            Append(message);
+            break;
+        }
+        }
+    }
+
+    // Seals the current batch and queues it on every subscriber that has room for it
+    void Flush() {
+        if (currentCount_ == 0) return;
+        auto& bytes = current_->bytes_;
+        BatchHeader header{ static_cast<std::uint32_t>(bytes.size()), currentCount_, ++batchSequence_, NowNanos() };
+        std::memcpy(bytes.data(), &header, sizeof(header));
+
+        BatchPointer batch = current_;
+        for (auto& client : clients_) {
+            if (client.queuedBytes_ + bytes.size() > config_.clientQueueBytes_) {
+                Bump(dropped_);
+                ++client.droppedBatches_;
+                continue;
+            }
+            client.queue_.push_back(batch);
+            client.queuedBytes_ += bytes.size();
+            client.droppedBatches_ = 0;
+        }
+        Bump(batches_);
+        Bump(messages_, currentCount_);
+        inFlight_.push_back(std::move(current_));
+        current_ = NewBatch();
+        currentCount_ = 0;
+        WriteClients();
+    }
+
+    // Returns false if the subscriber has gone away
+    bool WriteClient(Client& client) {
+        while (!client.queue_.empty()) {
+            iovec iov[kMaxIovecs];
+            int count = 0;
+            std::size_t offset = client.offset_;
+            for (auto it = client.queue_.begin(); it != client.queue_.end() && count < kMaxIovecs; ++it, offset = 0) {
+                iov[count].iov_base = const_cast<std::byte*>((*it)->bytes_.data() + offset);
+                iov[count].iov_len = (*it)->bytes_.size() - offset;
+                ++count;
+            }
+            msghdr message{};
+            message.msg_iov = iov;
+            message.msg_iovlen = count;
+            ssize_t written = sendmsg(client.fd_, &message, MSG_NOSIGNAL);
+            if (written < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            Bump(bytesSent_, static_cast<std::uint64_t>(written));
+
+            auto remaining = static_cast<std::size_t>(written);
+            while (remaining > 0) {
+                std::size_t left = client.queue_.front()->bytes_.size() - client.offset_;
+                if (remaining < left) {
+                    client.offset_ += remaining;
+                    break;
+                }
+                remaining -= left;
+                client.queuedBytes_ -= client.queue_.front()->bytes_.size();
+                client.queue_.pop_front();
+                client.offset_ = 0;
+            }
+            if (client.offset_ != 0) return true;   // socket buffer is full
+        }
+        return true;
+    }
+
+    void WriteClients() {
+        for (std::size_t i = 0; i < clients_.size();) {
+            Client& client = clients_[i];
+            bool slow = config_.maxDroppedBatches_ && client.droppedBatches_ >= config_.maxDroppedBatches_;
+            if (slow || !WriteClient(client)) {
+                if (slow) Bump(disconnected_);
+                close(client.fd_);
+                clients_[i] = std::move(clients_.back());
+                clients_.pop_back();
+                continue;
+            }
+            ++i;
+        }
+        clientCount_.store(clients_.size(), std::memory_order_relaxed);
+        RecycleBatches();
+    }
+
+    void Run() {
+        PinCurrentThread(config_.cpu_);
+        EngineEvent event;
+        while (true) {
+            bool stopping = !running_.load(std::memory_order_acquire);
+            bool any = false;
+            while (engine_.PollEvent(event)) {
+                Encode(event);
+                any = true;
+            }
+            Flush();
+            if (stopping && !any) break;
+            AcceptClients();
+            if (!any) {
+                WriteClients();
+                std::this_thread::yield();
+            }
+        }
+        // give subscribers a bounded grace period to take what is already queued for them
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (std::any_of(clients_.begin(), clients_.end(), [](const Client& client) { return !client.queue_.empty(); })
+               && std::chrono::steady_clock::now() < deadline) {
+            WriteClients();
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    MarketDataPublisher(MatchingEngine& engine, PublisherConfig config = {})
+        : engine_{ engine }
+        , config_{ std::move(config) }
+    {
+        if (config_.maxBatchBytes_ < sizeof(BatchHeader) + kMaxMessageSize)
+            throw std::invalid_argument("Batch size too small for one message");
+        Listen();
+        current_ = NewBatch();
+    }
+
+    ~MarketDataPublisher() {
+        Stop();
+        for (auto& client : clients_) close(client.fd_);
+        if (listenFd_ >= 0) close(listenFd_);
+        if (config_.transport_ == Transport::Unix) unlink(config_.path_.c_str());
+    }
+
+    MarketDataPublisher(const MarketDataPublisher&) = delete;
+    MarketDataPublisher& operator=(const MarketDataPublisher&) = delete;
+
+    void Start() {
+        if (running_.exchange(true)) return;
+        thread_ = std::thread([this] { Run(); });
+    }
+
+    // Publishes whatever the engine has already emitted, then joins the publisher thread.
+    // Subscribers stay connected until the publisher is destroyed.
+    void Stop() {
+        running_.store(false, std::memory_order_release);
+        if (thread_.joinable()) thread_.join();
+    }
+
+    const std::string& GetPath() const { return config_.path_; }
+    std::uint16_t GetPort() const { return port_; }
+
+    PublisherStats GetStats() const {
+        PublisherStats stats;
+        stats.clients_ = clientCount_.load(std::memory_order_relaxed);
+        stats.batches_ = batches_.load(std::memory_order_relaxed);
+        stats.messages_ = messages_.load(std::memory_order_relaxed);
+        stats.bytesSent_ = bytesSent_.load(std::memory_order_relaxed);
+        stats.batchesDropped_ = dropped_.load(std::memory_order_relaxed);
+        stats.slowConsumersDisconnected_ = disconnected_.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
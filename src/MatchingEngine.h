@@ -0,0 +1,436 @@
+#pragma once
+#include "Analytics.h"
+#include "BookSnapshot.h"
+#include "Command.h"
+#include "Journal.h"
+#include "MarketData.h"
+#include "Metrics.h"
+#include "orderbook.h"
+#include "RingBuffer.h"
+#include "SeqLock.h"
+#include "Trade.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// What a producer does when the inbound ring is full
+enum class BackpressurePolicy
+{
+	Spin,
+	Yield,
+	Reject
+};
+
+struct EngineConfig {
+    std::size_t inboundCapacity_{1 << 16};
+    std::size_t outboundCapacity_{1 << 16};
+    BackpressurePolicy backpressure_{BackpressurePolicy::Yield};
+    std::size_t batchSize_{256};
+    std::size_t depthLevels_{10};   // L2 depth of published snapshots, at most kMaxSnapshotDepth
+    bool levelUpdates_{true};       // stream L2 deltas on the outbound ring
+    std::size_t snapshotInterval_{1000};   // full-depth snapshot every N batches touching a book, 0 = never
+    int cpu_{-1};   // core to pin the engine thread to, -1 to leave it to the scheduler
+    std::optional<AnalyticsConfig> analytics_;   // bars, VWAP and imbalance per book; off when empty
+};
+
+enum class EngineEventType : std::uint8_t
+{
+	Trade,
+	TopOfBook,
+	LevelUpdate,
+	SnapshotBegin,
+	SnapshotLevel
+};
+
+// Outbound message:
+//  Trade          trade_
+//  TopOfBook      bestBid_/bestAsk_ after a batch changed them
+//  LevelUpdate    level_, one L2 delta in book sequence order
+//  SnapshotBegin  level_.sequence_ the snapshot is keyed by, count_ SnapshotLevel events follow
+//  SnapshotLevel  level_, one level of that snapshot
+struct EngineEvent {
+    EngineEventType type_{EngineEventType::Trade};
+    Symbol symbol_{0};
+    std::uint32_t count_{0};
+    Trade trade_{};
+    LevelInfo bestBid_{};
+    LevelInfo bestAsk_{};
+    LevelUpdate level_{};
+};
+
+// Counters the engine thread publishes for monitoring; readable from any thread
+struct EngineStats {
+    std::uint64_t commandsProcessed_{0};
+    std::uint64_t commandsRejected_{0};
+    std::uint64_t producerRejects_{0};
+    std::uint64_t eventsDropped_{0};
+    std::size_t queueDepth_{0};
+    std::uint64_t meanLatencyNanos_{0};
+    std::uint64_t maxLatencyNanos_{0};
+};
+
+// Pins the calling thread to one core; a no-op where affinity is not supported
+inline void PinCurrentThread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+// What the engine's books report: only rejects are counted, whether or not the call also throws
+struct RejectCounter {
+    std::uint64_t rejects_{0};
+
+    void OnAccept(const OrderEvent&) { }
+    void OnPartialFill(const OrderEvent&) { }
+    void OnFill(const OrderEvent&) { }
+    void OnCancel(const OrderEvent&) { }
+    void OnReject(const OrderEvent&, RejectReason) { ++rejects_; }
+};
+
+// Single-writer matching engine: one thread owns its OrderBooks outright and is the only thing
+// that ever touches them. Any number of producer threads submit commands through a lock-free
+// MPSC ring; trades and top-of-book changes come back out on an SPSC ring for one consumer.
+// After every batch each touched book publishes a BookSnapshot through a SeqLock, so display,
+// risk and market-data threads read a consistent top of book without ever blocking the matcher.
+// An engine can own several books, one per symbol; by default it owns a single book for symbol 0.
+class MatchingEngine {
+private:
+    struct BookState {
+        Symbol symbol_;
+        BasicOrderBook<RejectCounter> book_;
+        LevelInfo lastBestBid_{};
+        LevelInfo lastBestAsk_{};
+        bool touched_{false};
+        std::uint64_t batches_{0};
+        SeqLock<BookSnapshot> snapshot_;
+        std::unique_ptr<MarketAnalytics> analytics_;
+
+        BookState(Symbol symbol, OrderBook book)
+            : symbol_{ symbol }
+            , book_{ std::move(book) }
+        { }
+    };
+
+    static constexpr std::uint32_t kNoBook = static_cast<std::uint32_t>(-1);
+
+    EngineConfig config_;
+    std::vector<std::unique_ptr<BookState>> books_;
+    std::vector<std::uint32_t> bookIndex_;   // symbol -> books_ slot
+    std::vector<BookState*> touched_;
+    LevelUpdates levelUpdates_;
+    Trades trades_;   // the current command's fills; reused so a match does not allocate once warm
+    Timestamp batchTime_{0};   // wall clock at the start of the batch, what analytics are timed by
+    Journal* journal_{nullptr};
+    std::uint64_t checkpointInterval_{0};
+    std::uint64_t lastCheckpoint_{0};
+    ThreadMetrics* metrics_{nullptr};   // recorded by the engine thread only
+    MpscRing<Command> inbound_;
+    SpscRing<EngineEvent> outbound_;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    alignas(64) std::atomic<std::uint64_t> producerRejects_{0};
+
+    // written by the engine thread only
+    alignas(64) std::atomic<std::uint64_t> processed_{0};
+    std::atomic<std::uint64_t> rejected_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> latencySum_{0};
+    std::atomic<std::uint64_t> latencyMax_{0};
+
+    BookState* FindBook(Symbol symbol) const {
+        if (symbol >= bookIndex_.size() || bookIndex_[symbol] == kNoBook) return nullptr;
+        return books_[bookIndex_[symbol]].get();
+    }
+
+    void Publish(const EngineEvent& event) {
+        if (!outbound_.TryPush(event))
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static MetricOperation OperationOf(const Command& command, const Trades& trades) {
+        switch (command.type_) {
+        case CommandType::Add: return trades.empty() ? MetricOperation::Add : MetricOperation::Match;
+        case CommandType::Cancel: return MetricOperation::Cancel;
+        case CommandType::Modify: return MetricOperation::Modify;
+        case CommandType::AdvanceClock: return MetricOperation::Cancel;   // expiries are cancels
+        case CommandType::CancelSide:
+        case CommandType::CancelRange:
+        case CommandType::CancelOwner: return MetricOperation::Cancel;
+        }
+        return MetricOperation::Add;
+    }
+
+    void Apply(const Command& command) {
+        if (journal_) journal_->Append(command);
+        BookState* state = FindBook(command.symbol_);
+        Trades& trades = trades_;
+        trades.clear();
+        std::int64_t started = 0;
+        if constexpr (kMetricsEnabled) if (metrics_) started = NowNanos();
+        // A command counts once as rejected, whether the book reported it, threw, or both
+        bool rejected = false;
+        try {
+            if (!state) throw std::out_of_range("Unknown symbol");
+            std::uint64_t rejects = state->book_.GetListener().rejects_;
+            state->book_.Apply(command, trades);
+            rejected = state->book_.GetListener().rejects_ != rejects;
+            if (state->analytics_) state->analytics_->OnTrades(trades, batchTime_);
+            if (!state->touched_) {
+                state->touched_ = true;
+                touched_.push_back(state);
+            }
+        } catch (const std::exception&) {
+            rejected = true;
+        }
+        if (rejected) {
+            rejected_.store(rejected_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if constexpr (kMetricsEnabled) if (metrics_) metrics_->RecordReject();
+        }
+        std::int64_t now = NowNanos();
+        if constexpr (kMetricsEnabled) {
+            if (metrics_) {
+                metrics_->RecordOperation(OperationOf(command, trades), static_cast<std::uint64_t>(now - started));
+                if (!trades.empty()) metrics_->tradesPerMatch_.Record(trades.size());
+            }
+        }
+
+        for (const auto& trade : trades)
+            Publish(EngineEvent{ EngineEventType::Trade, command.symbol_, 0, trade });
+
+        for (const auto& update : levelUpdates_) {
+            EngineEvent event{ EngineEventType::LevelUpdate, command.symbol_ };
+            event.level_ = update;
+            Publish(event);
+        }
+        levelUpdates_.clear();
+
+        auto latency = static_cast<std::uint64_t>(now - command.enqueuedAt_);
+        latencySum_.store(latencySum_.load(std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+        if (latency > latencyMax_.load(std::memory_order_relaxed))
+            latencyMax_.store(latency, std::memory_order_relaxed);
+        processed_.store(processed_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Full depth, bracketed by a SnapshotBegin so a consumer knows how many levels follow
+    void PublishL2Snapshot(const BookState& state) {
+        L2Snapshot snapshot = state.book_.GetL2Snapshot();
+        EngineEvent begin{ EngineEventType::SnapshotBegin, state.symbol_ };
+        begin.count_ = static_cast<std::uint32_t>(snapshot.bids_.size() + snapshot.asks_.size());
+        begin.level_.sequence_ = snapshot.sequence_;
+        Publish(begin);
+        for (Side side : { Side::BID, Side::ASK }) {
+            for (const auto& level : side == Side::BID ? snapshot.bids_ : snapshot.asks_) {
+                EngineEvent event{ EngineEventType::SnapshotLevel, state.symbol_ };
+                event.level_ = LevelUpdate{ level.price_, level.quantity_, side, snapshot.sequence_ };
+                Publish(event);
+            }
+        }
+    }
+
+    void PublishSnapshot(BookState& state) {
+        BookSnapshot snapshot;
+        snapshot.sequence_ = state.book_.GetSequence();
+        snapshot.symbol_ = state.symbol_;
+        std::size_t depth = std::min(config_.depthLevels_, kMaxSnapshotDepth);
+        snapshot.bidCount_ = static_cast<std::uint32_t>(state.book_.GetBids(std::span<LevelInfo>(snapshot.bids_, depth)));
+        snapshot.askCount_ = static_cast<std::uint32_t>(state.book_.GetAsks(std::span<LevelInfo>(snapshot.asks_, depth)));
+        state.snapshot_.Store(snapshot);
+    }
+
+    // Snapshots and top-of-book events for the books this batch touched
+    void PublishBooks() {
+        for (BookState* state : touched_) {
+            state->touched_ = false;
+            if constexpr (kMetricsEnabled) if (metrics_) metrics_->bookDepth_.Record(state->book_.Size());
+            PublishSnapshot(*state);
+            if (state->analytics_) {
+                state->analytics_->Advance(batchTime_);
+                state->analytics_->OnBook(state->book_);
+                state->analytics_->Publish();
+            }
+            if (config_.snapshotInterval_ && ++state->batches_ % config_.snapshotInterval_ == 0)
+                PublishL2Snapshot(*state);
+            LevelInfo bestBid = state->book_.GetBestBid();
+            LevelInfo bestAsk = state->book_.GetBestAsk();
+            if (bestBid.price_ == state->lastBestBid_.price_ && bestBid.quantity_ == state->lastBestBid_.quantity_
+                && bestAsk.price_ == state->lastBestAsk_.price_ && bestAsk.quantity_ == state->lastBestAsk_.quantity_)
+                continue;
+            EngineEvent event{ EngineEventType::TopOfBook, state->symbol_ };
+            event.bestBid_ = bestBid;
+            event.bestAsk_ = bestAsk;
+            Publish(event);
+            state->lastBestBid_ = bestBid;
+            state->lastBestAsk_ = bestAsk;
+        }
+        touched_.clear();
+    }
+
+    void Run() {
+        PinCurrentThread(config_.cpu_);
+        Command command;
+        while (true) {
+            bool stopping = !running_.load(std::memory_order_acquire);
+            if (config_.analytics_) batchTime_ = WallNanos();
+            std::size_t drained = 0;
+            while (drained < config_.batchSize_ && inbound_.TryPop(command)) {
+                Apply(command);
+                ++drained;
+            }
+            if (drained > 0) {
+                if constexpr (kMetricsEnabled) if (metrics_) metrics_->queueDepth_.Record(inbound_.Size());
+                PublishBooks();
+                if (checkpointInterval_ && journal_->GetSequence() - lastCheckpoint_ >= checkpointInterval_) Checkpoint();
+            } else if (stopping) {
+                break;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Stalls this engine for O(resting orders); size checkpointInterval_ accordingly
+    void Checkpoint() {
+        BasicSymbolBookRefs<RejectCounter> books;
+        for (const auto& state : books_) books.emplace_back(state->symbol_, &state->book_);
+        lastCheckpoint_ = journal_->GetSequence();
+        WriteCheckpoint(journal_->GetDirectory(), lastCheckpoint_, books);
+        journal_->ReleaseBefore(lastCheckpoint_ + 1);
+    }
+
+    const BookState& GetBookState(Symbol symbol) const {
+        const BookState* state = FindBook(symbol);
+        if (!state) throw std::out_of_range("Unknown symbol");
+        return *state;
+    }
+
+public:
+    explicit MatchingEngine(EngineConfig config = {}, OrderBook book = {})
+        : config_{ config }
+        , inbound_{ config.inboundCapacity_ }
+        , outbound_{ config.outboundCapacity_ }
+    {
+        AddBook(0, std::move(book));
+    }
+
+    // Engine that starts with no books; add them with AddBook before Start
+    struct NoBooks {};
+    MatchingEngine(EngineConfig config, NoBooks)
+        : config_{ config }
+        , inbound_{ config.inboundCapacity_ }
+        , outbound_{ config.outboundCapacity_ }
+    { }
+
+    ~MatchingEngine() { Stop(); }
+
+    MatchingEngine(const MatchingEngine&) = delete;
+    MatchingEngine& operator=(const MatchingEngine&) = delete;
+
+    // Not thread-safe: books must all be added before Start
+    void AddBook(Symbol symbol, OrderBook book = {}) {
+        if (running_.load()) throw std::logic_error("Books cannot be added to a running engine");
+        if (FindBook(symbol)) throw std::invalid_argument("Symbol already has a book");
+        if (symbol >= bookIndex_.size()) bookIndex_.resize(symbol + 1, kNoBook);
+        bookIndex_[symbol] = static_cast<std::uint32_t>(books_.size());
+        books_.push_back(std::make_unique<BookState>(symbol, std::move(book)));
+        if (config_.analytics_) books_.back()->analytics_ = std::make_unique<MarketAnalytics>(*config_.analytics_);
+        if (config_.levelUpdates_) books_.back()->book_.SetLevelUpdateSink(&levelUpdates_);
+        PublishSnapshot(*books_.back());
+        touched_.reserve(books_.size());
+    }
+
+    // Not thread-safe: set before Start. Every command is journaled before it is applied, and every
+    // checkpointInterval commands (0 = never) the engine checkpoints its books into the journal's
+    // directory. journal must outlive the engine.
+    void SetJournal(Journal* journal, std::uint64_t checkpointInterval = 0) {
+        if (running_.load()) throw std::logic_error("Journal cannot be changed on a running engine");
+        journal_ = journal;
+        checkpointInterval_ = journal ? checkpointInterval : 0;
+        lastCheckpoint_ = journal ? journal->GetSequence() : 0;
+    }
+
+    // Not thread-safe: set before Start. The engine thread records into a block registered under
+    // name; registry must outlive the engine. Compiled out with ORDERBOOK_METRICS=0.
+    void SetMetrics(MetricsRegistry* registry, std::string name = "engine") {
+        if (running_.load()) throw std::logic_error("Metrics cannot be changed on a running engine");
+        metrics_ = registry ? &registry->Register(std::move(name)) : nullptr;
+    }
+
+    bool HasBook(Symbol symbol) const { return FindBook(symbol) != nullptr; }
+    std::size_t BookCount() const { return books_.size(); }
+
+    void Start() {
+        if (running_.exchange(true)) return;
+        thread_ = std::thread([this] { Run(); });
+    }
+
+    // Drains whatever is already queued, then joins the engine thread
+    void Stop() {
+        running_.store(false, std::memory_order_release);
+        if (thread_.joinable()) thread_.join();
+    }
+
+    // Thread-safe. Returns false only under BackpressurePolicy::Reject with a full ring.
+    bool Submit(Command command) {
+        command.enqueuedAt_ = NowNanos();
+        while (!inbound_.TryPush(command)) {
+            switch (config_.backpressure_) {
+            case BackpressurePolicy::Spin:
+                break;
+            case BackpressurePolicy::Yield:
+                std::this_thread::yield();
+                break;
+            case BackpressurePolicy::Reject:
+                producerRejects_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Single consumer only
+    bool PollEvent(EngineEvent& event) { return outbound_.TryPop(event); }
+
+    // Any thread, wait-free with respect to the engine; cost is O(depth), never O(orders)
+    BookSnapshot GetSnapshot(Symbol symbol = 0) const { return GetBookState(symbol).snapshot_.Load(); }
+
+    // Any thread, wait-free with respect to the engine; as of the end of the last batch that
+    // touched the book. Throws if the engine was configured without analytics.
+    AnalyticsSnapshot GetAnalytics(Symbol symbol = 0) const {
+        const BookState& state = GetBookState(symbol);
+        if (!state.analytics_) throw std::logic_error("Analytics are not enabled");
+        return state.analytics_->Load();
+    }
+
+    LevelInfos GetBids(size_t levels, Symbol symbol = 0) const { return GetSnapshot(symbol).GetBids(levels); }
+    LevelInfos GetAsks(size_t levels, Symbol symbol = 0) const { return GetSnapshot(symbol).GetAsks(levels); }
+
+    EngineStats GetStats() const {
+        EngineStats stats;
+        stats.commandsProcessed_ = processed_.load(std::memory_order_relaxed);
+        stats.commandsRejected_ = rejected_.load(std::memory_order_relaxed);
+        stats.producerRejects_ = producerRejects_.load(std::memory_order_relaxed);
+        stats.eventsDropped_ = dropped_.load(std::memory_order_relaxed);
+        stats.queueDepth_ = inbound_.Size();
+        stats.meanLatencyNanos_ = stats.commandsProcessed_ ? latencySum_.load(std::memory_order_relaxed) / stats.commandsProcessed_ : 0;
+        stats.maxLatencyNanos_ = latencyMax_.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
@@ -0,0 +1,242 @@
+#pragma once
+#include "using.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Hot-path instrumentation. Build with -DORDERBOOK_METRICS=0 to compile every recording call
+// out, so the cost of measuring can itself be measured.
+#ifndef ORDERBOOK_METRICS
+#define ORDERBOOK_METRICS 1
+#endif
+
+constexpr bool kMetricsEnabled = ORDERBOOK_METRICS != 0;
+
+enum class MetricOperation : std::uint8_t
+{
+	Add,      // rested without trading
+	Cancel,
+	Modify,
+	Match,    // an add that traded
+	Count
+};
+
+constexpr const char* kMetricOperationNames[] = { "add", "cancel", "modify", "match" };
+constexpr std::size_t kMetricOperations = static_cast<std::size_t>(MetricOperation::Count);
+
+// Fixed-bucket log-linear histogram: four buckets per power of two (at most 25% wide), 0..3
+// exact. Written by one thread with plain relaxed stores; any thread may read it.
+class MetricHistogram {
+public:
+    static constexpr std::size_t kBuckets = 252;
+
+    static std::size_t BucketOf(std::uint64_t value) {
+        if (value < 4) return static_cast<std::size_t>(value);
+        int msb = 63 - std::countl_zero(value);
+        return static_cast<std::size_t>(4 * (msb - 1)) + ((value >> (msb - 2)) & 3);
+    }
+
+    // Largest value that lands in bucket
+    static std::uint64_t BucketUpper(std::size_t bucket) {
+        if (bucket < 4) return bucket;
+        int msb = static_cast<int>(bucket / 4) + 1;
+        std::uint64_t width = std::uint64_t{ 1 } << (msb - 2);
+        return (4 + bucket % 4) * width + width - 1;
+    }
+
+    void Record(std::uint64_t value) {
+        Bump(counts_[BucketOf(value)], 1);
+        Bump(count_, 1);
+        Bump(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) max_.store(value, std::memory_order_relaxed);
+    }
+
+private:
+    friend struct HistogramSummary;
+
+    std::array<std::atomic<std::uint64_t>, kBuckets> counts_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> max_{0};
+
+    static void Bump(std::atomic<std::uint64_t>& counter, std::uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+};
+
+// Plain copy of one or more MetricHistograms, taken and merged off the hot path
+struct HistogramSummary {
+    std::array<std::uint64_t, MetricHistogram::kBuckets> counts_{};
+    std::uint64_t count_{0};
+    std::uint64_t sum_{0};
+    std::uint64_t max_{0};
+
+    void Merge(const MetricHistogram& histogram) {
+        for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += histogram.counts_[i].load(std::memory_order_relaxed);
+        count_ += histogram.count_.load(std::memory_order_relaxed);
+        sum_ += histogram.sum_.load(std::memory_order_relaxed);
+        max_ = std::max(max_, histogram.max_.load(std::memory_order_relaxed));
+    }
+
+    void Merge(const HistogramSummary& other) {
+        for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    double Mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    // Upper bound of the bucket holding percentile p in [0, 100]
+    std::uint64_t Percentile(double p) const {
+        if (count_ == 0) return 0;
+        auto target = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(count_));
+        target = std::max<std::uint64_t>(target, 1);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= target) return std::min(MetricHistogram::BucketUpper(i), max_);
+        }
+        return max_;
+    }
+};
+
+// One thread's instruments. Only the owning thread records; each block sits on its own cache
+// lines so threads never share a line they write.
+struct alignas(64) ThreadMetrics {
+    std::string name_;
+    MetricHistogram latency_[kMetricOperations];   // nanoseconds per operation; count_ is the operation count
+    MetricHistogram tradesPerMatch_;               // sum_ is the trade count
+    MetricHistogram bookDepth_;                    // resting orders, sampled once per batch
+    MetricHistogram queueDepth_;                   // inbound commands waiting, sampled once per batch
+    std::atomic<std::uint64_t> rejected_{0};
+
+    explicit ThreadMetrics(std::string name) : name_{ std::move(name) } { }
+
+    void RecordOperation(MetricOperation operation, std::uint64_t nanos) {
+        latency_[static_cast<std::size_t>(operation)].Record(nanos);
+    }
+
+    void RecordReject() { rejected_.store(rejected_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+};
+
+struct ThreadMetricsSummary {
+    std::string name_;
+    HistogramSummary latency_[kMetricOperations];
+    HistogramSummary tradesPerMatch_;
+    HistogramSummary bookDepth_;
+    HistogramSummary queueDepth_;
+    std::uint64_t rejected_{0};
+
+    void Merge(const ThreadMetricsSummary& other) {
+        for (std::size_t i = 0; i < kMetricOperations; ++i) latency_[i].Merge(other.latency_[i]);
+        tradesPerMatch_.Merge(other.tradesPerMatch_);
+        bookDepth_.Merge(other.bookDepth_);
+        queueDepth_.Merge(other.queueDepth_);
+        rejected_ += other.rejected_;
+    }
+};
+
+// Owns every thread's ThreadMetrics. Registering takes a lock and happens once per thread;
+// recording never does. Readers aggregate a consistent-enough view at any time: each counter is
+// exact, counters read a few nanoseconds apart may disagree by the operations in between.
+class MetricsRegistry {
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadMetrics>> threads_;
+    std::chrono::steady_clock::time_point started_{ std::chrono::steady_clock::now() };
+
+    static void WriteHistogram(std::ostream& out, const HistogramSummary& histogram) {
+        out << "{\"count\":" << histogram.count_ << ",\"mean\":" << histogram.Mean()
+            << ",\"p50\":" << histogram.Percentile(50) << ",\"p99\":" << histogram.Percentile(99)
+            << ",\"p999\":" << histogram.Percentile(99.9) << ",\"max\":" << histogram.max_ << "}";
+    }
+
+    static void WriteSummary(std::ostream& out, const ThreadMetricsSummary& summary, double seconds) {
+        out << "{\"name\":\"" << summary.name_ << "\",\"operations\":{";
+        for (std::size_t i = 0; i < kMetricOperations; ++i) {
+            out << (i ? "," : "") << "\"" << kMetricOperationNames[i] << "\":";
+            WriteHistogram(out, summary.latency_[i]);
+        }
+        std::uint64_t operations = 0;
+        for (const auto& latency : summary.latency_) operations += latency.count_;
+        out << "},\"operations_per_sec\":" << (seconds > 0 ? operations / seconds : 0.0)
+            << ",\"trades\":" << summary.tradesPerMatch_.sum_
+            << ",\"rejected\":" << summary.rejected_
+            << ",\"trades_per_match\":";
+        WriteHistogram(out, summary.tradesPerMatch_);
+        out << ",\"book_depth\":";
+        WriteHistogram(out, summary.bookDepth_);
+        out << ",\"queue_depth\":";
+        WriteHistogram(out, summary.queueDepth_);
+        out << "}";
+    }
+
+public:
+    // The returned block stays valid for the registry's lifetime
+    ThreadMetrics& Register(std::string name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.push_back(std::make_unique<ThreadMetrics>(std::move(name)));
+        return *threads_.back();
+    }
+
+    std::vector<ThreadMetricsSummary> Summaries() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<ThreadMetricsSummary> summaries(threads_.size());
+        for (std::size_t t = 0; t < threads_.size(); ++t) {
+            const ThreadMetrics& metrics = *threads_[t];
+            ThreadMetricsSummary& summary = summaries[t];
+            summary.name_ = metrics.name_;
+            for (std::size_t i = 0; i < kMetricOperations; ++i) summary.latency_[i].Merge(metrics.latency_[i]);
+            summary.tradesPerMatch_.Merge(metrics.tradesPerMatch_);
+            summary.bookDepth_.Merge(metrics.bookDepth_);
+            summary.queueDepth_.Merge(metrics.queueDepth_);
+            summary.rejected_ = metrics.rejected_.load(std::memory_order_relaxed);
+        }
+        return summaries;
+    }
+
+    // {"uptime_sec", "enabled", "total": {...}, "threads": [{...}, ...]}
+    std::string ToJson() const {
+        auto summaries = Summaries();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+        ThreadMetricsSummary total;
+        total.name_ = "total";
+        for (const auto& summary : summaries) total.Merge(summary);
+
+        std::ostringstream out;
+        out << "{\"uptime_sec\":" << seconds << ",\"enabled\":" << (kMetricsEnabled ? "true" : "false") << ",\"total\":";
+        WriteSummary(out, total, seconds);
+        out << ",\"threads\":[";
+        for (std::size_t t = 0; t < summaries.size(); ++t) {
+            out << (t ? "," : "");
+            WriteSummary(out, summaries[t], seconds);
+        }
+        out << "]}\n";
+        return out.str();
+    }
+
+    // One line per thread and operation, for humans
+    std::string ToText() const {
+        std::ostringstream out;
+        for (const auto& summary : Summaries()) {
+            out << summary.name_ << ": trades=" << summary.tradesPerMatch_.sum_ << " rejected=" << summary.rejected_
+                << " depth p50=" << summary.bookDepth_.Percentile(50) << " queue p99=" << summary.queueDepth_.Percentile(99) << "\n";
+            for (std::size_t i = 0; i < kMetricOperations; ++i) {
+                const auto& latency = summary.latency_[i];
+                out << "  " << kMetricOperationNames[i] << " n=" << latency.count_ << " p50=" << latency.Percentile(50)
+                    << " p99=" << latency.Percentile(99) << " max=" << latency.max_ << " ns\n";
+            }
+        }
+        return out.str();
+    }
+};
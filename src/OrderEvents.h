@@ -0,0 +1,52 @@
+#pragma once
+#include "using.h"
+#include <concepts>
+
+enum class RejectReason
+{
+	DuplicateOrderId,
+	UnknownOrderId,          // cancel or modify of an order that is not on the book; reported with known_ false
+	NoLiquidity,             // FillAndKill that does not cross, Market into an empty side
+	InsufficientLiquidity,   // FillOrKill that cannot fill completely
+	InvalidPrice,            // outside a dense ladder or off tick; the call also throws
+	InvalidOrderType         // the call also throws
+};
+
+// One order's state right after something happened to it
+struct OrderEvent {
+    OrderId orderId_{0};
+    OrderId contraOrderId_{0};        // fills: the order on the other side
+    Price price_{0};                  // fills: the execution (resting) price; otherwise the order's price
+    Quantity quantity_{0};            // accepted, filled or cancelled by this event
+    Quantity remainingQuantity_{0};   // still open afterwards
+    Side side_{Side::BID};
+    OrderType orderType_{OrderType::GoodTillCancel};   // as submitted
+    OrderStatus status_{OrderStatus::NEW};
+    bool known_{true};                // false only for an UnknownOrderId reject: there was no order, so
+                                      // side_, orderType_ and price_ are not an order's; per-side stats skip it
+};
+
+// What a book reports, in the order it happens; the book calls these directly, so they inline.
+//  OnAccept       passed validation, before any fill: NEW
+//  OnPartialFill  PARTIALLY_FILLED; the two sides of one fill are reported bid first
+//  OnFill         FILLED
+//  OnCancel       CANCELLED with nothing remaining, or an in-place reduction by quantity_ that
+//                 keeps the order's status
+//  OnReject       REJECTED; the book did not change
+template <typename L>
+concept OrderListener = requires(L listener, const OrderEvent& event, RejectReason reason) {
+    listener.OnAccept(event);
+    listener.OnPartialFill(event);
+    listener.OnFill(event);
+    listener.OnCancel(event);
+    listener.OnReject(event, reason);
+};
+
+// The default: every call is empty, so a book without a listener builds no events at all
+struct NullOrderListener {
+    void OnAccept(const OrderEvent&) { }
+    void OnPartialFill(const OrderEvent&) { }
+    void OnFill(const OrderEvent&) { }
+    void OnCancel(const OrderEvent&) { }
+    void OnReject(const OrderEvent&, RejectReason) { }
+};
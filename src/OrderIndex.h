@@ -0,0 +1,104 @@
+#pragma once
+#include "order.h"
+#include "using.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// OrderId -> resting Order* index: one flat array of (id, order) slots with linear probing.
+// A lookup is usually a single cache miss, inserts never allocate below the reserved size, and
+// erase shifts the rest of the probe run back instead of leaving tombstones, so cancel-heavy
+// flow never degrades probe lengths or forces a cleanup rehash.
+// Ids are spread with a Fibonacci multiply, so dense sequential ids fill slots evenly and
+// strided id schemes do not pile up on a few slots. A null order marks an empty slot.
+class OrderIndex {
+private:
+    struct Slot {
+        OrderId orderId_{0};
+        Order* order_{nullptr};
+    };
+
+    // Grow once more than 3/4 of the slots are used; keeps expected probes short
+    static constexpr std::size_t kLoadNumerator = 3;
+    static constexpr std::size_t kLoadDenominator = 4;
+    static constexpr std::size_t kMinSlots = 16;
+
+    std::vector<Slot> slots_;
+    std::size_t mask_{0};
+    int shift_{64};
+    std::size_t size_{0};
+
+    std::size_t Home(OrderId orderId) const {
+        return static_cast<std::size_t>((orderId * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    // Slot holding orderId, or the empty slot ending its probe run
+    std::size_t Probe(OrderId orderId) const {
+        std::size_t i = Home(orderId);
+        while (slots_[i].order_ && slots_[i].orderId_ != orderId) i = (i + 1) & mask_;
+        return i;
+    }
+
+    void Rehash(std::size_t slotCount) {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(slotCount, Slot{});
+        mask_ = slotCount - 1;
+        shift_ = 64 - std::countr_zero(slotCount);
+        for (const Slot& slot : old)
+            if (slot.order_) slots_[Probe(slot.orderId_)] = slot;
+    }
+
+    static std::size_t SlotsFor(std::size_t count) {
+        return std::max(kMinSlots, std::bit_ceil(count * kLoadDenominator / kLoadNumerator + 1));
+    }
+
+public:
+    OrderIndex() { Rehash(kMinSlots); }
+
+    // Size the table so count orders fit without growing
+    void Reserve(std::size_t count) {
+        std::size_t slotCount = SlotsFor(count);
+        if (slotCount > slots_.size()) Rehash(slotCount);
+    }
+
+    Order* Find(OrderId orderId) const {
+        return slots_[Probe(orderId)].order_;
+    }
+
+    bool Contains(OrderId orderId) const { return Find(orderId) != nullptr; }
+
+    // False, and nothing changes, if orderId is already indexed
+    bool Insert(OrderId orderId, Order* order) {
+        if ((size_ + 1) * kLoadDenominator > slots_.size() * kLoadNumerator) Rehash(slots_.size() * 2);
+        Slot& slot = slots_[Probe(orderId)];
+        if (slot.order_) return false;
+        slot = Slot{ orderId, order };
+        ++size_;
+        return true;
+    }
+
+    // Removes orderId and returns its order, or nullptr if it was not indexed.
+    // Backward-shift deletion: later entries of the run move up into the hole unless that
+    // would put them before their home slot.
+    Order* Erase(OrderId orderId) {
+        std::size_t hole = Probe(orderId);
+        Order* order = slots_[hole].order_;
+        if (!order) return nullptr;
+        for (std::size_t next = (hole + 1) & mask_; slots_[next].order_; next = (next + 1) & mask_) {
+            std::size_t home = Home(slots_[next].orderId_);
+            // stays put when its home lies cyclically in (hole, next]
+            if (((next - home) & mask_) < ((next - hole) & mask_)) continue;
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+        slots_[hole] = Slot{};
+        --size_;
+        return order;
+    }
+
+    std::size_t Size() const { return size_; }
+    std::size_t Capacity() const { return slots_.size() * kLoadNumerator / kLoadDenominator; }
+    std::size_t MemoryBytes() const { return slots_.size() * sizeof(Slot); }
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include "order.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Slab allocator that owns the storage of every resting Order.
+// Orders live in fixed-size chunks of cache-line-aligned slots; released slots go on a
+// free list and are reused before a new chunk is taken from the heap, so once the pool has
+// grown to the working set, acquiring and releasing orders never allocates.
+// Slots never move, so an Order* stays a valid handle until it is released.
+class OrderPool {
+private:
+    union alignas(64) Slot {
+        Slot* next_;
+        alignas(Order) unsigned char storage_[sizeof(Order)];
+    };
+
+    static_assert(std::is_trivially_destructible_v<Order>, "pool drops live orders without destroying them");
+
+    std::size_t chunkSize_;
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    Slot* freeList_{nullptr};
+
+    std::uint64_t acquired_{0};
+    std::uint64_t heapAllocations_{0};
+    std::size_t live_{0};
+
+    void Grow() {
+        chunks_.push_back(std::make_unique<Slot[]>(chunkSize_));
+        ++heapAllocations_;
+        Slot* chunk = chunks_.back().get();
+        for (std::size_t i = chunkSize_; i-- > 0;) {
+            chunk[i].next_ = freeList_;
+            freeList_ = &chunk[i];
+        }
+    }
+
+public:
+    explicit OrderPool(std::size_t chunkSize = 4096)
+        : chunkSize_{ chunkSize }
+    { }
+
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    OrderPool(OrderPool&& other) noexcept
+        : chunkSize_{ other.chunkSize_ }
+        , chunks_{ std::move(other.chunks_) }
+        , freeList_{ std::exchange(other.freeList_, nullptr) }
+        , acquired_{ other.acquired_ }
+        , heapAllocations_{ other.heapAllocations_ }
+        , live_{ std::exchange(other.live_, 0) }
+    { }
+
+    OrderPool& operator=(OrderPool&& other) noexcept {
+        chunkSize_ = other.chunkSize_;
+        chunks_ = std::move(other.chunks_);
+        freeList_ = std::exchange(other.freeList_, nullptr);
+        acquired_ = other.acquired_;
+        heapAllocations_ = other.heapAllocations_;
+        live_ = std::exchange(other.live_, 0);
+        return *this;
+    }
+
+    // Make room for at least count live orders up front
+    void Reserve(std::size_t count) {
+        while (chunks_.size() * chunkSize_ < count) Grow();
+    }
+
+    template <typename... Args>
+    Order* Acquire(Args&&... args) {
+        if (!freeList_) Grow();
+        Slot* slot = freeList_;
+        freeList_ = slot->next_;
+        ++acquired_;
+        ++live_;
+        return ::new (static_cast<void*>(slot->storage_)) Order(std::forward<Args>(args)...);
+    }
+
+    void Release(Order* order) {
+        order->~Order();
+        Slot* slot = reinterpret_cast<Slot*>(order);
+        slot->next_ = freeList_;
+        freeList_ = slot;
+        --live_;
+    }
+
+    static constexpr std::size_t SlotSize() { return sizeof(Slot); }
+
+    std::size_t Live() const { return live_; }
+    std::size_t Capacity() const { return chunks_.size() * chunkSize_; }
+
+    // Heap allocations made per million orders acquired since the last ResetCounters();
+    // stays at zero once the pool covers the steady-state working set
+    double AllocationsPerMillionOrders() const {
+        return acquired_ == 0 ? 0.0 : heapAllocations_ * 1e6 / static_cast<double>(acquired_);
+    }
+
+    std::uint64_t HeapAllocations() const { return heapAllocations_; }
+    std::uint64_t Acquired() const { return acquired_; }
+
+    void ResetCounters() {
+        acquired_ = 0;
+        heapAllocations_ = 0;
+    }
+};
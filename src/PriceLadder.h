@@ -0,0 +1,157 @@
+#pragma once
+#include "PriceLevel.h"
+#include "using.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+// Price band a dense book is allowed to trade in: levels_ slots starting at basePrice_, tickSize_ apart
+struct LadderConfig {
+    Price basePrice_;
+    Price tickSize_;
+    std::size_t levels_;
+};
+
+// Contiguous, tick-indexed price levels. Slot i holds price basePrice_ + i * tickSize_.
+// A two-level occupancy bitmap (one bit per level, one summary bit per 64 levels) lets the
+// next non-empty level in either direction be found with a couple of bit scans. Level quantities
+// are mirrored into one contiguous array (0 for empty slots) for the QuantityKernels reductions.
+class PriceLadder {
+private:
+    Price basePrice_{0};
+    Price tickSize_{1};
+    std::vector<PriceLevel> levels_;
+    std::vector<Quantity> quantities_;
+    std::vector<std::uint64_t> occupied_;
+    std::vector<std::uint64_t> summary_;
+
+    // price - basePrice_ for a price at or above the base, computed unsigned so that no price,
+    // however extreme, overflows
+    std::uint64_t OffsetOf(Price price) const {
+        return static_cast<std::uint64_t>(price) - static_cast<std::uint64_t>(basePrice_);
+    }
+
+    std::uint64_t Tick() const { return static_cast<std::uint64_t>(tickSize_); }
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    PriceLadder() = default;
+
+    explicit PriceLadder(const LadderConfig& config)
+        : basePrice_{ config.basePrice_ }
+        , tickSize_{ config.tickSize_ }
+        , levels_(config.levels_)
+        , quantities_(config.levels_)
+        , occupied_((config.levels_ + 63) / 64)
+        , summary_((occupied_.size() + 63) / 64)
+    {
+        if (config.tickSize_ <= 0)
+            throw std::invalid_argument("Tick size must be positive");
+        if (config.levels_ == 0)
+            throw std::invalid_argument("Ladder must have at least one level");
+    }
+
+    std::size_t Size() const { return levels_.size(); }
+    LadderConfig GetConfig() const { return LadderConfig{ basePrice_, tickSize_, levels_.size() }; }
+    Price PriceAt(std::size_t index) const { return basePrice_ + static_cast<Price>(index) * tickSize_; }
+
+    bool Contains(Price price) const {
+        if (price < basePrice_) return false;
+        std::uint64_t offset = OffsetOf(price);
+        return offset % Tick() == 0 && offset / Tick() < levels_.size();
+    }
+
+    std::size_t IndexOf(Price price) const {
+        if (!Contains(price))
+            throw std::out_of_range(std::format("Price ({}) is outside the ladder or off tick.", price));
+        return static_cast<std::size_t>(OffsetOf(price) / Tick());
+    }
+
+    // Highest index priced at or below price, or npos if every slot is above it
+    std::size_t IndexAtOrBelow(Price price) const {
+        if (price < basePrice_) return npos;
+        std::uint64_t index = OffsetOf(price) / Tick();
+        return index < levels_.size() ? static_cast<std::size_t>(index) : levels_.size() - 1;
+    }
+
+    // Lowest index priced at or above price, or npos if every slot is below it
+    std::size_t IndexAtOrAbove(Price price) const {
+        if (price <= basePrice_) return 0;
+        std::uint64_t offset = OffsetOf(price);
+        std::uint64_t index = offset / Tick() + (offset % Tick() != 0);
+        return index < levels_.size() ? static_cast<std::size_t>(index) : npos;
+    }
+
+    PriceLevel& At(std::size_t index) { return levels_[index]; }
+    const PriceLevel& At(std::size_t index) const { return levels_[index]; }
+
+    // Copies a slot's quantity into the contiguous array; call after every change to it
+    void SyncQuantity(const PriceLevel& level) {
+        quantities_[static_cast<std::size_t>(&level - levels_.data())] = level.quantity_;
+    }
+
+    const Quantity* Quantities() const { return quantities_.data(); }
+
+    bool IsOccupied(std::size_t index) const {
+        return (occupied_[index / 64] >> (index % 64)) & 1;
+    }
+
+    void MarkOccupied(std::size_t index) {
+        occupied_[index / 64] |= std::uint64_t{1} << (index % 64);
+        summary_[index / 4096] |= std::uint64_t{1} << ((index / 64) % 64);
+    }
+
+    void MarkEmpty(std::size_t index) {
+        std::size_t word = index / 64;
+        occupied_[word] &= ~(std::uint64_t{1} << (index % 64));
+        if (occupied_[word] == 0)
+            summary_[word / 64] &= ~(std::uint64_t{1} << (word % 64));
+    }
+
+    // Lowest occupied index >= from, or npos
+    std::size_t FindNextHigher(std::size_t from) const {
+        if (from >= levels_.size()) return npos;
+        std::size_t word = from / 64;
+        std::uint64_t bits = occupied_[word] & (~std::uint64_t{0} << (from % 64));
+        if (bits) return word * 64 + std::countr_zero(bits);
+
+        std::size_t next = word + 1;
+        std::size_t group = next / 64;
+        if (group >= summary_.size()) return npos;
+        std::uint64_t groups = next % 64 ? summary_[group] & (~std::uint64_t{0} << (next % 64)) : summary_[group];
+        while (true) {
+            if (groups) {
+                std::size_t found = group * 64 + std::countr_zero(groups);
+                return found * 64 + std::countr_zero(occupied_[found]);
+            }
+            if (++group >= summary_.size()) return npos;
+            groups = summary_[group];
+        }
+    }
+
+    // Highest occupied index <= from, or npos
+    std::size_t FindNextLower(std::size_t from) const {
+        if (from == npos) return npos;
+        if (from >= levels_.size()) from = levels_.size() - 1;
+        std::size_t word = from / 64;
+        std::uint64_t bits = occupied_[word] & (~std::uint64_t{0} >> (63 - from % 64));
+        if (bits) return word * 64 + 63 - std::countl_zero(bits);
+
+        if (word == 0) return npos;
+        std::size_t prev = word - 1;
+        std::size_t group = prev / 64;
+        std::uint64_t groups = summary_[group] & (~std::uint64_t{0} >> (63 - prev % 64));
+        while (true) {
+            if (groups) {
+                std::size_t found = group * 64 + 63 - std::countl_zero(groups);
+                return found * 64 + 63 - std::countl_zero(occupied_[found]);
+            }
+            if (group-- == 0) return npos;
+            groups = summary_[group];
+        }
+    }
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include "order.h"
+#include "using.h"
+
+// All resting orders at one price, in time priority, plus their aggregate remaining quantity
+struct PriceLevel {
+    OrderList orders_;
+    Quantity quantity_{0};
+
+    bool Empty() const { return orders_.Empty(); }
+};
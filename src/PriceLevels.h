@@ -0,0 +1,244 @@
+#pragma once
+#include "PriceLadder.h"
+#include "PriceLevel.h"
+#include "QuantityKernels.h"
+#include "using.h"
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
+#include <type_traits>
+
+// One side of the book. Levels live either in a dense PriceLadder (bounded tick band) or,
+// when no ladder is configured, in a std::map so any price can be quoted.
+// Levels are kept in priority order: highest price first for bids, lowest first for asks.
+template <Side S>
+class PriceLevels {
+private:
+    using Compare = std::conditional_t<S == Side::BID, std::greater<Price>, std::less<Price>>;
+
+    std::map<Price, PriceLevel, Compare> map_;
+    PriceLadder ladder_;
+    bool dense_{false};
+    std::size_t best_{PriceLadder::npos};
+
+    static bool IsBetter(std::size_t index, std::size_t than) {
+        if (than == PriceLadder::npos) return true;
+        if constexpr (S == Side::BID) return index > than;
+        else return index < than;
+    }
+
+    // price is on the far side of limit from the best level
+    static bool IsWorse(Price price, Price limit) {
+        if constexpr (S == Side::BID) return price < limit;
+        else return price > limit;
+    }
+
+    std::size_t NextFrom(std::size_t index) const {
+        if constexpr (S == Side::BID) return index == 0 ? PriceLadder::npos : ladder_.FindNextLower(index - 1);
+        else return ladder_.FindNextHigher(index + 1);
+    }
+
+public:
+    PriceLevels() = default;
+
+    explicit PriceLevels(const std::optional<LadderConfig>& ladder) {
+        if (ladder) {
+            ladder_ = PriceLadder{ *ladder };
+            dense_ = true;
+        }
+    }
+
+    bool IsDense() const { return dense_; }
+    std::optional<LadderConfig> GetLadderConfig() const { return dense_ ? std::optional{ ladder_.GetConfig() } : std::nullopt; }
+
+    // Whether GetOrCreate(price) can succeed; map mode takes any price
+    bool Accepts(Price price) const { return !dense_ || ladder_.Contains(price); }
+
+    // Throws what GetOrCreate(price) would for a price the side cannot hold
+    void CheckPrice(Price price) const {
+        if (dense_) ladder_.IndexOf(price);
+    }
+
+    bool Empty() const { return dense_ ? best_ == PriceLadder::npos : map_.empty(); }
+
+    // Level quantities change only through these, which keeps the ladder's quantity array in step
+    void AddQuantity(PriceLevel& level, Quantity quantity) {
+        level.quantity_ += quantity;
+        if (dense_) ladder_.SyncQuantity(level);
+    }
+
+    void RemoveQuantity(PriceLevel& level, Quantity quantity) {
+        level.quantity_ -= quantity;
+        if (dense_) ladder_.SyncQuantity(level);
+    }
+
+    Price BestPrice() const { return dense_ ? ladder_.PriceAt(best_) : map_.begin()->first; }
+
+    // Least aggressive price on the side; the side must not be empty
+    Price WorstPrice() const {
+        if (!dense_) return map_.rbegin()->first;
+        if constexpr (S == Side::BID) return ladder_.PriceAt(ladder_.FindNextHigher(0));
+        else return ladder_.PriceAt(ladder_.FindNextLower(ladder_.Size() - 1));
+    }
+    PriceLevel& BestLevel() { return dense_ ? ladder_.At(best_) : map_.begin()->second; }
+    const PriceLevel& BestLevel() const { return dense_ ? ladder_.At(best_) : map_.begin()->second; }
+
+    // Level for price, creating it if it is not on the book yet
+    PriceLevel& GetOrCreate(Price price) {
+        if (!dense_) return map_[price];
+
+        std::size_t index = ladder_.IndexOf(price);
+        if (!ladder_.IsOccupied(index)) {
+            ladder_.MarkOccupied(index);
+            if (IsBetter(index, best_)) best_ = index;
+        }
+        return ladder_.At(index);
+    }
+
+    PriceLevel* Find(Price price) {
+        if (!dense_) {
+            auto it = map_.find(price);
+            return it == map_.end() ? nullptr : &it->second;
+        }
+        std::size_t index = ladder_.IndexOf(price);
+        return ladder_.IsOccupied(index) ? &ladder_.At(index) : nullptr;
+    }
+
+    // Drop a level that has no resting orders left
+    void Erase(Price price) {
+        if (!dense_) {
+            map_.erase(price);
+            return;
+        }
+        std::size_t index = ladder_.IndexOf(price);
+        ladder_.MarkEmpty(index);
+        ladder_.At(index).quantity_ = 0;
+        ladder_.SyncQuantity(ladder_.At(index));
+        if (index == best_) best_ = NextFrom(index);
+    }
+
+    // Calls f(price, level) for each level priced within [low, high], in priority order. f may take
+    // orders off the level; one it leaves empty is dropped right after, so a band of levels is
+    // cleared in one pass instead of a lookup and erase per order.
+    template <typename F>
+    void ForEachLevelIn(Price low, Price high, F&& f) {
+        if (low > high || Empty()) return;
+        if (!dense_) {
+            auto it = S == Side::BID ? map_.lower_bound(high) : map_.lower_bound(low);
+            auto end = S == Side::BID ? map_.upper_bound(low) : map_.upper_bound(high);
+            while (it != end) {
+                f(it->first, it->second);
+                it = it->second.Empty() ? map_.erase(it) : std::next(it);
+            }
+            return;
+        }
+        std::size_t first = ladder_.IndexAtOrAbove(low);
+        std::size_t last = high >= ladder_.PriceAt(ladder_.Size() - 1) ? ladder_.Size() - 1 : ladder_.IndexAtOrBelow(high);
+        if (first == PriceLadder::npos || last == PriceLadder::npos || first > last) return;
+        std::size_t index = S == Side::BID ? ladder_.FindNextLower(last) : ladder_.FindNextHigher(first);
+        bool bestDropped = false;
+        while (index != PriceLadder::npos && index >= first && index <= last) {
+            std::size_t next = NextFrom(index);
+            PriceLevel& level = ladder_.At(index);
+            f(ladder_.PriceAt(index), level);
+            if (level.Empty()) {
+                ladder_.MarkEmpty(index);
+                level.quantity_ = 0;
+                ladder_.SyncQuantity(level);
+                bestDropped |= index == best_;
+            }
+            index = next;
+        }
+        if (bestDropped) best_ = S == Side::BID ? ladder_.FindNextLower(best_) : ladder_.FindNextHigher(best_);
+    }
+
+    // Whether the levels priced no worse than limit hold at least quantity. Dense sides run a
+    // vector reduction over the tick range; map sides walk the levels.
+    bool Covers(Price limit, std::uint64_t quantity) const {
+        if (quantity == 0) return true;
+        if (Empty()) return false;
+        if (!dense_) {
+            std::uint64_t available = 0;
+            ForEachLevel([&](Price price, const PriceLevel& level) {
+                if (IsWorse(price, limit)) return false;
+                available += level.quantity_;
+                return available < quantity;
+            });
+            return available >= quantity;
+        }
+        if constexpr (S == Side::BID) {
+            std::size_t low = ladder_.IndexAtOrAbove(limit);
+            if (low == PriceLadder::npos || low > best_) return false;
+            return QuantityKernels::CoverBackward(ladder_.Quantities() + low, best_ - low + 1, quantity) != QuantityKernels::npos;
+        } else {
+            std::size_t high = ladder_.IndexAtOrBelow(limit);
+            if (high == PriceLadder::npos || high < best_) return false;
+            return QuantityKernels::CoverForward(ladder_.Quantities() + best_, high - best_ + 1, quantity) != QuantityKernels::npos;
+        }
+    }
+
+    // Worst price that taking quantity from the best levels reaches, or nullopt if the side holds less
+    std::optional<Price> SweepPrice(std::uint64_t quantity) const {
+        if (Empty()) return std::nullopt;
+        if (quantity == 0) return BestPrice();
+        if (!dense_) {
+            std::uint64_t available = 0;
+            Price reached = 0;
+            ForEachLevel([&](Price price, const PriceLevel& level) {
+                available += level.quantity_;
+                reached = price;
+                return available < quantity;
+            });
+            return available >= quantity ? std::optional{ reached } : std::nullopt;
+        }
+        if constexpr (S == Side::BID) {
+            std::size_t levels = QuantityKernels::CoverBackward(ladder_.Quantities(), best_ + 1, quantity);
+            if (levels == QuantityKernels::npos) return std::nullopt;
+            return ladder_.PriceAt(best_ + 1 - levels);
+        } else {
+            std::size_t levels = QuantityKernels::CoverForward(ladder_.Quantities() + best_, ladder_.Size() - best_, quantity);
+            if (levels == QuantityKernels::npos) return std::nullopt;
+            return ladder_.PriceAt(best_ + levels - 1);
+        }
+    }
+
+    // Total quantity priced within distance of the best price, both ends included. The limit
+    // saturates, so a distance of numeric_limits<Price>::max() means the whole side.
+    std::uint64_t DepthWithin(Price distance) const {
+        if (Empty() || distance < 0) return 0;
+        Price best = BestPrice();
+        constexpr Price kMin = std::numeric_limits<Price>::min();
+        constexpr Price kMax = std::numeric_limits<Price>::max();
+        Price limit = S == Side::BID ? (best < kMin + distance ? kMin : best - distance)
+                                     : (best > kMax - distance ? kMax : best + distance);
+        if (!dense_) {
+            std::uint64_t depth = 0;
+            ForEachLevel([&](Price price, const PriceLevel& level) {
+                if (IsWorse(price, limit)) return false;
+                depth += level.quantity_;
+                return true;
+            });
+            return depth;
+        }
+        if constexpr (S == Side::BID) {
+            std::size_t low = ladder_.IndexAtOrAbove(limit);
+            return QuantityKernels::Sum(ladder_.Quantities() + low, best_ - low + 1);
+        } else {
+            std::size_t high = ladder_.IndexAtOrBelow(limit);
+            return QuantityKernels::Sum(ladder_.Quantities() + best_, high - best_ + 1);
+        }
+    }
+
+    // Calls f(price, level) for each level in priority order until f returns false
+    template <typename F>
+    void ForEachLevel(F&& f) const {
+        if (!dense_) {
+            for (const auto& [price, level] : map_)
+                if (!f(price, level)) return;
+            return;
+        }
+        for (std::size_t index = best_; index != PriceLadder::npos; index = NextFrom(index))
+            if (!f(ladder_.PriceAt(index), ladder_.At(index))) return;
+    }
+};
@@ -0,0 +1,159 @@
+#pragma once
+#include "using.h"
+#include <cstddef>
+#include <cstdint>
+
+// Reductions over a contiguous run of level quantities: the dense ladder's per-tick quantity
+// array, where empty ticks hold 0. The vector width is picked at compile time: AVX2 with
+// -mavx2/-march=native, SSE2 on any other x86-64 build, scalar elsewhere. Build with
+// -DORDERBOOK_SIMD=0 to force the scalar loops.
+#ifndef ORDERBOOK_SIMD
+#define ORDERBOOK_SIMD 1
+#endif
+
+#if ORDERBOOK_SIMD && defined(__AVX2__)
+#include <immintrin.h>
+#define ORDERBOOK_QUANTITY_AVX2 1
+#elif ORDERBOOK_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#define ORDERBOOK_QUANTITY_SSE2 1
+#endif
+
+// Sums and "how many levels until target" searches over q[0, n). Whole vector blocks are
+// added up in registers; only the block where a target is reached is walked one entry at a time.
+class QuantityKernels {
+private:
+#if defined(ORDERBOOK_QUANTITY_AVX2)
+    static constexpr std::size_t kLanes = 8;
+
+    // Sum of q[0, 8), widened to 64 bits so eight full quantities cannot overflow
+    static std::uint64_t BlockSum(const Quantity* q) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q));
+        __m256i wide = _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)),
+                                        _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+        return Horizontal(_mm_add_epi64(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1)));
+    }
+
+    // Sum of q[0, n) for n a multiple of kLanes, accumulated in four 64-bit lanes
+    static std::uint64_t BlocksSum(const Quantity* q, std::size_t n) {
+        __m256i accumulator = _mm256_setzero_si256();
+        for (std::size_t i = 0; i < n; i += kLanes) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + i));
+            accumulator = _mm256_add_epi64(accumulator, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+            accumulator = _mm256_add_epi64(accumulator, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+        }
+        return Horizontal(_mm_add_epi64(_mm256_castsi256_si128(accumulator), _mm256_extracti128_si256(accumulator, 1)));
+    }
+#elif defined(ORDERBOOK_QUANTITY_SSE2)
+    static constexpr std::size_t kLanes = 4;
+
+    static std::uint64_t BlockSum(const Quantity* q) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+        __m128i zero = _mm_setzero_si128();
+        return Horizontal(_mm_add_epi64(_mm_unpacklo_epi32(v, zero), _mm_unpackhi_epi32(v, zero)));
+    }
+
+    static std::uint64_t BlocksSum(const Quantity* q, std::size_t n) {
+        __m128i zero = _mm_setzero_si128();
+        __m128i accumulator = zero;
+        for (std::size_t i = 0; i < n; i += kLanes) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + i));
+            accumulator = _mm_add_epi64(accumulator, _mm_unpacklo_epi32(v, zero));
+            accumulator = _mm_add_epi64(accumulator, _mm_unpackhi_epi32(v, zero));
+        }
+        return Horizontal(accumulator);
+    }
+#else
+    static constexpr std::size_t kLanes = 1;
+
+    static std::uint64_t BlockSum(const Quantity* q) { return *q; }
+    static std::uint64_t BlocksSum(const Quantity* q, std::size_t n) { return SumScalar(q, n); }
+#endif
+
+#if defined(ORDERBOOK_QUANTITY_AVX2) || defined(ORDERBOOK_QUANTITY_SSE2)
+    static std::uint64_t Horizontal(__m128i v) {
+        return static_cast<std::uint64_t>(_mm_cvtsi128_si64(v)) + static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v)));
+    }
+#endif
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    static const char* Name() {
+#if defined(ORDERBOOK_QUANTITY_AVX2)
+        return "avx2";
+#elif defined(ORDERBOOK_QUANTITY_SSE2)
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+    static std::uint64_t Sum(const Quantity* q, std::size_t n) {
+        std::size_t blocks = n - n % kLanes;
+        std::uint64_t sum = BlocksSum(q, blocks);
+        for (std::size_t i = blocks; i < n; ++i) sum += q[i];
+        return sum;
+    }
+
+    // Fewest leading entries whose sum reaches target, or npos
+    static std::size_t CoverForward(const Quantity* q, std::size_t n, std::uint64_t target) {
+        if (target == 0) return 0;
+        std::uint64_t sum = 0;
+        std::size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            std::uint64_t block = BlockSum(q + i);
+            if (sum + block >= target) break;
+            sum += block;
+        }
+        for (; i < n; ++i) {
+            sum += q[i];
+            if (sum >= target) return i + 1;
+        }
+        return npos;
+    }
+
+    // Fewest trailing entries whose sum reaches target, or npos
+    static std::size_t CoverBackward(const Quantity* q, std::size_t n, std::uint64_t target) {
+        if (target == 0) return 0;
+        std::uint64_t sum = 0;
+        std::size_t end = n;
+        for (; end >= kLanes; end -= kLanes) {
+            std::uint64_t block = BlockSum(q + end - kLanes);
+            if (sum + block >= target) break;
+            sum += block;
+        }
+        for (; end > 0; --end) {
+            sum += q[end - 1];
+            if (sum >= target) return n - end + 1;
+        }
+        return npos;
+    }
+
+    // One entry at a time; the reference the vector versions are checked and benchmarked against
+    static std::uint64_t SumScalar(const Quantity* q, std::size_t n) {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < n; ++i) sum += q[i];
+        return sum;
+    }
+
+    static std::size_t CoverForwardScalar(const Quantity* q, std::size_t n, std::uint64_t target) {
+        if (target == 0) return 0;
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += q[i];
+            if (sum >= target) return i + 1;
+        }
+        return npos;
+    }
+
+    static std::size_t CoverBackwardScalar(const Quantity* q, std::size_t n, std::uint64_t target) {
+        if (target == 0) return 0;
+        std::uint64_t sum = 0;
+        for (std::size_t k = 1; k <= n; ++k) {
+            sum += q[n - k];
+            if (sum >= target) return k;
+        }
+        return npos;
+    }
+};
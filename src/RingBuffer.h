@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+// Bounded lock-free queues used to hand commands and events between threads.
+// Capacities are rounded up to a power of two.
+
+inline std::size_t RoundUpToPowerOfTwo(std::size_t n) {
+    std::size_t capacity = 1;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+
+// Many producers, one consumer. Each cell carries a sequence number that tells a producer
+// whether the slot is free for the lap it is on (Vyukov's bounded queue), so producers only
+// contend on a single fetch position and never wait on one another to finish writing.
+template <typename T>
+class MpscRing {
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence_;
+        T value_;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> enqueuePos_{0};
+    alignas(64) std::atomic<std::size_t> dequeuePos_{0};
+
+public:
+    explicit MpscRing(std::size_t capacity)
+        : cells_{ std::make_unique<Cell[]>(RoundUpToPowerOfTwo(capacity)) }
+        , mask_{ RoundUpToPowerOfTwo(capacity) - 1 }
+    {
+        if (capacity == 0) throw std::invalid_argument("Ring capacity must be positive");
+        for (std::size_t i = 0; i <= mask_; ++i)
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    // false when the ring is full
+    bool TryPush(const T& value) {
+        std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            std::size_t sequence = cell->sequence_.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value_ = value;
+        cell->sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side only; false when the ring is empty
+    bool TryPop(T& value) {
+        std::size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell& cell = cells_[pos & mask_];
+        if (cell.sequence_.load(std::memory_order_acquire) != pos + 1) return false;
+        value = cell.value_;
+        cell.sequence_.store(pos + mask_ + 1, std::memory_order_release);
+        dequeuePos_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Approximate number of queued items; safe to call from any thread
+    std::size_t Size() const {
+        std::size_t enqueued = enqueuePos_.load(std::memory_order_relaxed);
+        std::size_t dequeued = dequeuePos_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    std::size_t Capacity() const { return mask_ + 1; }
+};
+
+// One producer, one consumer. Each side caches the other's index so the shared cache line
+// is only read when the cached view says the ring looks full (or empty).
+template <typename T>
+class SpscRing {
+private:
+    std::unique_ptr<T[]> slots_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    std::size_t cachedTail_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    std::size_t cachedHead_{0};
+
+public:
+    explicit SpscRing(std::size_t capacity)
+        : slots_{ std::make_unique<T[]>(RoundUpToPowerOfTwo(capacity)) }
+        , mask_{ RoundUpToPowerOfTwo(capacity) - 1 }
+    {
+        if (capacity == 0) throw std::invalid_argument("Ring capacity must be positive");
+    }
+
+    // Producer side only; false when the ring is full
+    bool TryPush(const T& value) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ > mask_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_) return false;
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side only; false when the ring is empty
+    bool TryPop(T& value) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) return false;
+        }
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t Size() const {
+        std::size_t head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+    std::size_t Capacity() const { return mask_ + 1; }
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer, many-reader publication of a trivially copyable value.
+// The writer alternates between two sequence-locked buffers and then flips an index, so a
+// reader copies the most recently completed buffer while the writer fills the other one.
+// Readers never block the writer and only retry if the writer has published twice more
+// during their copy. The payload is moved as relaxed atomic words between acquire/release
+// fences, so concurrent reads and writes are well defined.
+template <typename T>
+class SeqLock {
+private:
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock payload must be trivially copyable");
+
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    struct alignas(64) Buffer {
+        std::atomic<std::uint64_t> sequence_{0};
+        std::array<std::atomic<std::uint64_t>, kWords> words_{};
+    };
+
+    Buffer buffers_[2];
+    alignas(64) std::atomic<std::uint64_t> published_{0};
+
+public:
+    SeqLock() { Store(T{}); }
+
+    // Writer thread only
+    void Store(const T& value) {
+        std::uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        std::uint64_t next = published_.load(std::memory_order_relaxed) + 1;
+        Buffer& buffer = buffers_[next & 1];
+        std::uint64_t sequence = buffer.sequence_.load(std::memory_order_relaxed);
+        buffer.sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; ++i)
+            buffer.words_[i].store(words[i], std::memory_order_relaxed);
+        buffer.sequence_.store(sequence + 2, std::memory_order_release);
+        published_.store(next, std::memory_order_release);
+    }
+
+    // Any thread; returns a consistent copy of the latest published value
+    T Load() const {
+        std::uint64_t words[kWords];
+        while (true) {
+            const Buffer& buffer = buffers_[published_.load(std::memory_order_acquire) & 1];
+            std::uint64_t before = buffer.sequence_.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            for (std::size_t i = 0; i < kWords; ++i)
+                words[i] = buffer.words_[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (buffer.sequence_.load(std::memory_order_relaxed) == before) break;
+        }
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // Number of values published so far
+    std::uint64_t Version() const { return published_.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include "Metrics.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct StatsConfig {
+    std::string filePath_;      // rewritten every interval_ with the JSON dump; empty = off
+    std::string socketPath_;    // Unix socket answering each connection with the JSON dump; empty = off
+    std::chrono::milliseconds interval_{1000};
+};
+
+// Exposes a MetricsRegistry off the hot path from its own thread: a JSON file replaced atomically
+// every interval, and/or a Unix socket that writes the current dump to whoever connects
+// (e.g. `socat - UNIX-CONNECT:/tmp/orderbook-stats.sock`) and closes.
+class StatsEndpoint {
+private:
+    const MetricsRegistry& registry_;
+    StatsConfig config_;
+    int listenFd_{-1};
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    void WriteFile() const {
+        std::string json = registry_.ToJson();
+        std::string temp = config_.filePath_ + ".tmp";
+        if (FILE* file = std::fopen(temp.c_str(), "w")) {
+            bool ok = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+            ok = std::fclose(file) == 0 && ok;
+            if (ok) std::rename(temp.c_str(), config_.filePath_.c_str());
+        }
+    }
+
+    void Serve() const {
+        while (true) {
+            int fd = accept(listenFd_, nullptr, nullptr);
+            if (fd < 0) return;
+            std::string json = registry_.ToJson();
+            std::size_t sent = 0;
+            while (sent < json.size()) {
+                ssize_t n = send(fd, json.data() + sent, json.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                sent += static_cast<std::size_t>(n);
+            }
+            close(fd);
+        }
+    }
+
+    void Run() {
+        auto nextWrite = std::chrono::steady_clock::now();
+        while (running_.load(std::memory_order_acquire)) {
+            auto now = std::chrono::steady_clock::now();
+            if (!config_.filePath_.empty() && now >= nextWrite) {
+                WriteFile();
+                nextWrite = now + config_.interval_;
+            }
+            if (listenFd_ >= 0) {
+                pollfd fd{ listenFd_, POLLIN, 0 };
+                if (poll(&fd, 1, 100) > 0) Serve();
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+        if (!config_.filePath_.empty()) WriteFile();   // final figures
+    }
+
+public:
+    // registry must outlive the endpoint
+    StatsEndpoint(const MetricsRegistry& registry, StatsConfig config)
+        : registry_{ registry }
+        , config_{ std::move(config) }
+    { }
+
+    ~StatsEndpoint() { Stop(); }
+
+    StatsEndpoint(const StatsEndpoint&) = delete;
+    StatsEndpoint& operator=(const StatsEndpoint&) = delete;
+
+    void Start() {
+        if (running_.load()) return;
+        if (!config_.socketPath_.empty()) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (config_.socketPath_.size() >= sizeof(address.sun_path))
+                throw std::invalid_argument("Stats socket path is too long");
+            std::strncpy(address.sun_path, config_.socketPath_.c_str(), sizeof(address.sun_path) - 1);
+            listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (listenFd_ < 0) throw std::system_error(errno, std::generic_category(), "socket");
+            unlink(config_.socketPath_.c_str());
+            if (bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+                throw std::system_error(errno, std::generic_category(), "bind " + config_.socketPath_);
+            if (listen(listenFd_, 16) < 0) throw std::system_error(errno, std::generic_category(), "listen");
+        }
+        running_.store(true);
+        thread_ = std::thread([this] { Run(); });
+    }
+
+    void Stop() {
+        running_.store(false, std::memory_order_release);
+        if (thread_.joinable()) thread_.join();
+        if (listenFd_ >= 0) {
+            close(listenFd_);
+            listenFd_ = -1;
+            unlink(config_.socketPath_.c_str());
+        }
+    }
+};
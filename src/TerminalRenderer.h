@@ -0,0 +1,181 @@
+#pragma once
+#include "BookSnapshot.h"
+#include "RingBuffer.h"
+#include "TerminalColors.h"
+#include "Trade.h"
+#include "using.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <unistd.h>
+
+// Lossy hand-off of trades to a display. The market-data thread pushes without ever waiting; a
+// trade that finds the ring full is counted and dropped, since a display only shows summaries.
+class TradeTape {
+private:
+    SpscRing<Trade> ring_;
+    std::atomic<std::uint64_t> dropped_{0};
+
+public:
+    explicit TradeTape(std::size_t capacity = 4096)
+        : ring_{ capacity }
+    { }
+
+    // Producer side only
+    void Push(const Trade& trade) {
+        if (!ring_.TryPush(trade))
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Consumer side only: calls f(trade) for every trade queued so far and returns how many
+    template <typename F>
+    std::size_t Drain(F&& f) {
+        Trade trade;
+        std::size_t count = 0;
+        while (ring_.TryPop(trade)) {
+            f(trade);
+            ++count;
+        }
+        return count;
+    }
+
+    std::uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+};
+
+// What a display shows instead of a line per trade
+struct TradeSummary {
+    std::uint64_t trades_{0};
+    std::uint64_t volume_{0};
+    Price low_{0};
+    Price high_{0};
+    Price last_{0};
+
+    void Add(const Trade& trade) {
+        Price price = trade.GetPrice();
+        low_ = trades_ ? std::min(low_, price) : price;
+        high_ = trades_ ? std::max(high_, price) : price;
+        last_ = price;
+        volume_ += trade.GetQuantity();
+        ++trades_;
+    }
+};
+
+// Draws a screen of text rows to a terminal and, on each later frame, rewrites only the rows that
+// changed: a cursor move to the row, its text and a clear to end of line. A frame goes out in one
+// write(2), so a display never interleaves partial frames with anything else and costs one system
+// call per frame however much of the screen changed. Rows must not contain newlines.
+class TerminalRenderer {
+private:
+    int fd_;
+    bool started_{false};
+    std::vector<std::string> shown_;   // what the terminal holds, row by row
+    std::string frame_;                // the next write, reused across frames
+    std::uint64_t frames_{0};
+    std::uint64_t bytes_{0};
+
+    void MoveTo(std::size_t row) { frame_ += std::format("\033[{};1H", row + 1); }
+
+    void Flush() {
+        const char* data = frame_.data();
+        std::size_t left = frame_.size();
+        while (left > 0) {
+            ssize_t written = ::write(fd_, data, left);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "terminal write");
+            }
+            data += written;
+            left -= static_cast<std::size_t>(written);
+        }
+        bytes_ += frame_.size();
+        ++frames_;
+    }
+
+public:
+    explicit TerminalRenderer(int fd = STDOUT_FILENO)
+        : fd_{ fd }
+    { }
+
+    // Shows the cursor again below the last row
+    ~TerminalRenderer() {
+        if (!started_) return;
+        frame_.clear();
+        MoveTo(shown_.size());
+        frame_ += "\033[?25h";
+        (void)::write(fd_, frame_.data(), frame_.size());
+    }
+
+    TerminalRenderer(const TerminalRenderer&) = delete;
+    TerminalRenderer& operator=(const TerminalRenderer&) = delete;
+
+    // Brings the screen from the last frame to rows; returns the bytes written (0 if nothing changed)
+    std::size_t Render(std::span<const std::string> rows) {
+        frame_.clear();
+        if (!started_) {
+            frame_ += "\033[?25l\033[2J";   // hide the cursor, clear once
+            started_ = true;
+        }
+        for (std::size_t row = 0; row < rows.size(); ++row) {
+            if (row < shown_.size() && shown_[row] == rows[row]) continue;
+            MoveTo(row);
+            frame_ += rows[row];
+            frame_ += "\033[K";
+        }
+        for (std::size_t row = rows.size(); row < shown_.size(); ++row) {
+            MoveTo(row);
+            frame_ += "\033[K";
+        }
+        shown_.resize(rows.size());
+        for (std::size_t row = 0; row < rows.size(); ++row)
+            if (shown_[row] != rows[row]) shown_[row] = rows[row];
+        if (frame_.empty()) return 0;
+        Flush();
+        return frame_.size();
+    }
+
+    // The next frame redraws every row, e.g. after something else wrote to the terminal
+    void Invalidate() {
+        shown_.clear();
+        started_ = false;
+    }
+
+    std::uint64_t FramesWritten() const { return frames_; }
+    std::uint64_t BytesWritten() const { return bytes_; }
+};
+
+// The book panel of the demo display: depth ask rows (best at the bottom), then depth bid rows
+// (best at the top). Always the same number of rows, so a level coming or going only rewrites
+// its own row.
+inline void AppendBookRows(std::vector<std::string>& rows, const BookSnapshot& snapshot, std::size_t depth) {
+    using namespace TerminalColors;
+    auto level = [&](const std::string& color, const LevelInfo* info) {
+        if (!info) return color + "║                                ║" + RESET;
+        return color + std::format("║ {:8} | {:8}        ║", info->price_, info->quantity_) + RESET;
+    };
+    std::size_t asks = std::min<std::size_t>(depth, snapshot.askCount_);
+    std::size_t bids = std::min<std::size_t>(depth, snapshot.bidCount_);
+    rows.push_back(BOLD + "╔════════════════════════════════╗" + RESET);
+    rows.push_back(BOLD + "║         ORDER BOOK             ║" + RESET);
+    rows.push_back(BOLD + "╠════════════════════════════════╣" + RESET);
+    rows.push_back(RED + "║ SELLS:                         ║" + RESET);
+    for (std::size_t i = depth; i-- > 0;) rows.push_back(level(RED, i < asks ? &snapshot.asks_[i] : nullptr));
+    rows.push_back(BOLD + "╠════════════════════════════════╣" + RESET);
+    rows.push_back(GREEN + "║ BUYS:                          ║" + RESET);
+    for (std::size_t i = 0; i < depth; ++i) rows.push_back(level(GREEN, i < bids ? &snapshot.bids_[i] : nullptr));
+    rows.push_back(BOLD + "╚════════════════════════════════╝" + RESET);
+}
+
+// One summary row for the trades of a period, plus how many the tape dropped so far
+inline void AppendTradeRows(std::vector<std::string>& rows, const TradeSummary& summary, std::uint64_t dropped) {
+    using namespace TerminalColors;
+    if (summary.trades_ == 0) rows.push_back(BOLD + "TRADES: " + RESET + "none in the last second");
+    else rows.push_back(BOLD + "TRADES: " + RESET + std::format("{} in the last second, volume {}, range {}-{}, last {}",
+        summary.trades_, summary.volume_, summary.low_, summary.high_, summary.last_));
+    if (dropped) rows.push_back(std::format("({} trades not shown: display fell behind)", dropped));
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "using.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Hashed timing wheel: slot i holds every timer whose expiry tick is i modulo the slot count.
+// Scheduling is an O(1) push; advancing the clock visits only the slots for the ticks that have
+// passed (at most one revolution) and fires their due entries in bulk. Entries due on a later
+// revolution stay put. There is no cancel: owners check on fire whether the timer is still wanted,
+// which keeps cancel and fill paths free of timer bookkeeping.
+template <typename T>
+class TimerWheel {
+private:
+    struct Entry {
+        Timestamp expiry_;
+        T value_;
+    };
+
+    std::vector<std::vector<Entry>> slots_;
+    std::vector<Entry> firing_;
+    std::size_t mask_;
+    Timestamp resolution_;
+    Timestamp now_{0};
+    std::size_t size_{0};
+
+    std::size_t SlotOf(Timestamp time) const { return static_cast<std::size_t>(time / resolution_) & mask_; }
+
+public:
+    explicit TimerWheel(std::size_t slots = 256, Timestamp resolution = 1'000'000'000)
+        : resolution_{ resolution }
+    {
+        if (slots == 0 || (slots & (slots - 1)) != 0) throw std::invalid_argument("Timer wheel slot count must be a power of two");
+        if (resolution <= 0) throw std::invalid_argument("Timer wheel resolution must be positive");
+        slots_.resize(slots);
+        mask_ = slots - 1;
+    }
+
+    // A timer already due fires on the next Advance
+    void Schedule(Timestamp expiry, T value) {
+        slots_[SlotOf(std::max(expiry, now_))].push_back(Entry{ expiry, value });
+        ++size_;
+    }
+
+    // Moves the clock to now and calls fire(value) for every timer with expiry <= now
+    template <typename F>
+    void Advance(Timestamp now, F&& fire) {
+        if (now < now_) return;
+        Timestamp first = now_ / resolution_;
+        Timestamp last = now / resolution_;
+        now_ = now;
+        if (size_ == 0) return;
+        Timestamp ticks = std::min<Timestamp>(last - first + 1, static_cast<Timestamp>(slots_.size()));
+        for (Timestamp tick = 0; tick < ticks; ++tick) {
+            auto& slot = slots_[static_cast<std::size_t>(first + tick) & mask_];
+            firing_.swap(slot);   // fire may schedule new timers
+            for (const auto& entry : firing_) {
+                if (entry.expiry_ <= now) {
+                    --size_;
+                    fire(entry.value_);
+                } else {
+                    slots_[SlotOf(entry.expiry_)].push_back(entry);
+                }
+            }
+            firing_.clear();
+        }
+    }
+
+    Timestamp Now() const { return now_; }
+    std::size_t Size() const { return size_; }
+};
@@ -3,22 +3,48 @@
 #include "using.h"
 #include <vector>
 
-// aggregation of 2 tradeInfo objects -> for a trade to happen in the orderbook -> a bid order needs to be filled by an ask
+// One fill between a bid and an ask. Both sides trade the same quantity, so it is stored once;
+// GetBidTrade/GetAskTrade rebuild the per-side view. Each side's price is its own order's price;
+// the fill executed at the resting (non-aggressor) side's, which GetPrice returns.
 class Trade {
     private:
-    TradeInfo bidTrade_;
-    TradeInfo askTrade_;
+    OrderId bidOrderId_{0};
+    OrderId askOrderId_{0};
+    Price bidPrice_{0};
+    Price askPrice_{0};
+    Quantity quantity_{0};
+    Side aggressor_{Side::BID};   // the side that took liquidity
     
     public:
+        Trade() = default;
+
+        Trade(OrderId bidOrderId, OrderId askOrderId, Price bidPrice, Price askPrice, Quantity quantity, Side aggressor = Side::BID)
+            : bidOrderId_{ bidOrderId }
+            , askOrderId_{ askOrderId }
+            , bidPrice_{ bidPrice }
+            , askPrice_{ askPrice }
+            , quantity_{ quantity }
+            , aggressor_{ aggressor }
+        { }
+
         Trade(const TradeInfo& bidTrade, const TradeInfo& askTrade)
-            : bidTrade_{ bidTrade }
-            , askTrade_{ askTrade }
+            : Trade{ bidTrade.orderId_, askTrade.orderId_, bidTrade.price_, askTrade.price_, bidTrade.quantity_ }
         { }
 
-    const TradeInfo& GetBidTrade() const { return bidTrade_; }
-    const TradeInfo& GetAskTrade() const { return askTrade_; }
+    TradeInfo GetBidTrade() const { return TradeInfo{ bidOrderId_, bidPrice_, quantity_ }; }
+    TradeInfo GetAskTrade() const { return TradeInfo{ askOrderId_, askPrice_, quantity_ }; }
+
+    OrderId GetBidOrderId() const { return bidOrderId_; }
+    OrderId GetAskOrderId() const { return askOrderId_; }
+    Price GetBidPrice() const { return bidPrice_; }
+    Price GetAskPrice() const { return askPrice_; }
+    Quantity GetQuantity() const { return quantity_; }
+    Side GetAggressor() const { return aggressor_; }
+    Price GetPrice() const { return aggressor_ == Side::BID ? askPrice_ : bidPrice_; }
 };
 
+static_assert(sizeof(Trade) == 40);
+
 // Per level info -> shown in an arr like L1 and L2
 struct LevelInfo
 {
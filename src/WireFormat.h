@@ -0,0 +1,119 @@
+#pragma once
+#include "using.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+// Binary market-data wire format. Every message is a fixed-layout, little-endian struct with
+// explicit padding, so encoding is a single store of the struct and decoding a single memcpy;
+// nothing is serialized field by field.
+//
+// The stream is a sequence of batches: a BatchHeader followed by count_ messages. Each message
+// starts with a MessageHeader whose length_ lets a reader skip types it does not know.
+// batchSequence_ increases by one per batch on a connection; a jump means the publisher dropped
+// batches for this subscriber, which must then resync on the next SnapshotBegin.
+static_assert(std::endian::native == std::endian::little, "wire format is little-endian and written without byte swaps");
+
+enum class MessageType : std::uint8_t
+{
+	Trade = 1,
+	TopOfBook = 2,
+	LevelUpdate = 3,
+	SnapshotBegin = 4,
+	SnapshotLevel = 5
+};
+
+struct BatchHeader {
+    std::uint32_t length_;          // bytes, header included
+    std::uint32_t count_;           // messages that follow
+    std::uint64_t batchSequence_;
+    std::int64_t sendTime_;         // publisher's steady clock at flush, nanoseconds
+};
+
+struct MessageHeader {
+    std::uint16_t length_;
+    MessageType type_;
+    std::uint8_t side_;             // Side for level messages, 0 otherwise
+    Symbol symbol_;
+};
+
+struct TradeMessage {
+    MessageHeader header_;
+    OrderId bidOrderId_;
+    OrderId askOrderId_;
+    Price bidPrice_;
+    Price askPrice_;
+    Quantity quantity_;
+    std::uint8_t aggressor_;        // Side of the incoming order that took liquidity
+    std::uint8_t padding_[3];
+};
+
+struct TopOfBookMessage {
+    MessageHeader header_;
+    Price bidPrice_;
+    Price askPrice_;
+    Quantity bidQuantity_;
+    Quantity askQuantity_;
+};
+
+// LevelUpdate and SnapshotLevel share this layout
+struct LevelMessage {
+    MessageHeader header_;
+    Price price_;
+    std::uint64_t sequence_;
+    Quantity quantity_;
+    std::uint32_t padding_;
+};
+
+struct SnapshotBeginMessage {
+    MessageHeader header_;
+    std::uint64_t sequence_;
+    std::uint32_t levelCount_;
+    std::uint32_t padding_;
+};
+
+static_assert(sizeof(BatchHeader) == 24);
+static_assert(sizeof(MessageHeader) == 8);
+static_assert(sizeof(TradeMessage) == 48);
+static_assert(sizeof(TopOfBookMessage) == 32);
+static_assert(sizeof(LevelMessage) == 32);
+static_assert(sizeof(SnapshotBeginMessage) == 24);
+
+// Largest message, so a writer can check space once per message
+constexpr std::size_t kMaxMessageSize = sizeof(TradeMessage);
+
+template <typename Message>
+Message MakeMessage(MessageType type, Symbol symbol, std::uint8_t side = 0) {
+    static_assert(std::is_trivially_copyable_v<Message>);
+    Message message{};
+    message.header_ = MessageHeader{ static_cast<std::uint16_t>(sizeof(Message)), type, side, symbol };
+    return message;
+}
+
+template <typename Message>
+Message ReadMessage(const std::byte* bytes) {
+    static_assert(std::is_trivially_copyable_v<Message>);
+    Message message;
+    std::memcpy(&message, bytes, sizeof(Message));
+    return message;
+}
+
+// Calls f(header, bytes) for each message of a complete batch; returns false if the batch is malformed
+template <typename F>
+bool ForEachMessage(std::span<const std::byte> batch, F&& f) {
+    if (batch.size() < sizeof(BatchHeader)) return false;
+    auto header = ReadMessage<BatchHeader>(batch.data());
+    if (header.length_ != batch.size()) return false;
+    std::size_t offset = sizeof(BatchHeader);
+    for (std::uint32_t i = 0; i < header.count_; ++i) {
+        if (batch.size() - offset < sizeof(MessageHeader)) return false;
+        auto message = ReadMessage<MessageHeader>(batch.data() + offset);
+        if (message.length_ < sizeof(MessageHeader) || message.length_ > batch.size() - offset) return false;
+        f(message, batch.data() + offset);
+        offset += message.length_;
+    }
+    return offset == batch.size();
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include "MatchingEngine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+struct PoolConfig {
+    std::size_t threads_{0};   // 0 = one per hardware thread
+    bool pinThreads_{false};
+    int firstCpu_{0};          // worker i is pinned to firstCpu_ + i when pinThreads_ is set
+    bool stealing_{true};      // off: each worker runs only what it was dealt, for comparison
+};
+
+struct PoolWorkerStats {
+    std::size_t jobs_{0};
+    std::size_t steals_{0};
+    std::uint64_t busyNanos_{0};
+};
+
+struct PoolRunStats {
+    std::uint64_t wallNanos_{0};
+    std::vector<PoolWorkerStats> workers_;
+
+    // Busiest worker over the average one: 1.0 means no worker waited on a straggler
+    double Imbalance() const {
+        std::uint64_t total = 0, busiest = 0;
+        for (const auto& worker : workers_) {
+            total += worker.busyNanos_;
+            busiest = std::max(busiest, worker.busyNanos_);
+        }
+        return total ? static_cast<double>(busiest) * workers_.size() / total : 1.0;
+    }
+};
+
+// Runs a fixed set of independent jobs of uneven cost on a pool of threads until all are done.
+// Jobs are dealt round-robin, costliest first, so every worker starts on its own largest job.
+// A worker takes its own jobs from the front (costliest remaining) and, once out of work,
+// steals one job at a time from the back of another worker's queue (cheapest remaining), so
+// small jobs fill in around the large ones and no worker sits idle while another has a backlog.
+// Each queue is a slice of one array with its two ends packed into one atomic word; the owner
+// and thieves claim a job with a single CAS, so nothing locks.
+// A single job costlier than total / threads still bounds the run; split such inputs upstream.
+class WorkStealingPool {
+private:
+    // [front, back) of a worker's slice of the dealt job order, 32 bits each
+    struct alignas(64) Queue {
+        std::atomic<std::uint64_t> ends_{0};
+    };
+
+    static std::uint64_t Pack(std::uint32_t front, std::uint32_t back) { return static_cast<std::uint64_t>(back) << 32 | front; }
+    static std::uint32_t Front(std::uint64_t ends) { return static_cast<std::uint32_t>(ends); }
+    static std::uint32_t Back(std::uint64_t ends) { return static_cast<std::uint32_t>(ends >> 32); }
+
+    PoolConfig config_;
+
+    static bool TakeFront(Queue& queue, std::uint32_t& slot) {
+        std::uint64_t ends = queue.ends_.load(std::memory_order_acquire);
+        while (Front(ends) < Back(ends)) {
+            if (queue.ends_.compare_exchange_weak(ends, Pack(Front(ends) + 1, Back(ends)), std::memory_order_acq_rel)) {
+                slot = Front(ends);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool TakeBack(Queue& queue, std::uint32_t& slot) {
+        std::uint64_t ends = queue.ends_.load(std::memory_order_acquire);
+        while (Front(ends) < Back(ends)) {
+            if (queue.ends_.compare_exchange_weak(ends, Pack(Front(ends), Back(ends) - 1), std::memory_order_acq_rel)) {
+                slot = Back(ends) - 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    explicit WorkStealingPool(PoolConfig config = {})
+        : config_{ config }
+    {
+        if (config_.threads_ == 0) config_.threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::size_t Threads() const { return config_.threads_; }
+
+    // Calls run(job, worker) once for every job in [0, costs.size()); costs only order the work.
+    // The first exception thrown by run is rethrown once every worker has stopped.
+    template <typename F>
+    PoolRunStats Run(const std::vector<std::uint64_t>& costs, F&& run) {
+        std::size_t workers = std::min(config_.threads_, std::max<std::size_t>(costs.size(), 1));
+        std::vector<std::uint32_t> byCost(costs.size());
+        std::iota(byCost.begin(), byCost.end(), 0u);
+        std::stable_sort(byCost.begin(), byCost.end(), [&](std::uint32_t a, std::uint32_t b) { return costs[a] > costs[b]; });
+
+        // worker w's slice holds jobs w, w + workers, w + 2 * workers, ... of byCost
+        std::vector<std::uint32_t> order;
+        order.reserve(costs.size());
+        std::vector<Queue> queues(workers);
+        for (std::size_t w = 0; w < workers; ++w) {
+            auto front = static_cast<std::uint32_t>(order.size());
+            for (std::size_t i = w; i < byCost.size(); i += workers) order.push_back(byCost[i]);
+            queues[w].ends_.store(Pack(front, static_cast<std::uint32_t>(order.size())), std::memory_order_relaxed);
+        }
+
+        PoolRunStats stats;
+        stats.workers_.resize(workers);
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+
+        auto work = [&](std::size_t self) {
+            PinCurrentThread(config_.pinThreads_ ? config_.firstCpu_ + static_cast<int>(self) : -1);
+            PoolWorkerStats& mine = stats.workers_[self];
+            while (!failed.load(std::memory_order_relaxed)) {
+                std::uint32_t slot;
+                bool stolen = false;
+                if (!TakeFront(queues[self], slot)) {
+                    if (!config_.stealing_) break;
+                    for (std::size_t k = 1; k < workers && !stolen; ++k) stolen = TakeBack(queues[(self + k) % workers], slot);
+                    if (!stolen) break;   // every queue is empty and nothing new is ever added
+                }
+                auto started = std::chrono::steady_clock::now();
+                try {
+                    run(static_cast<std::size_t>(order[slot]), self);
+                } catch (...) {
+                    if (!failed.exchange(true)) error = std::current_exception();
+                }
+                mine.busyNanos_ += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - started).count());
+                ++mine.jobs_;
+                mine.steals_ += stolen;
+            }
+        };
+
+        auto started = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for (std::size_t w = 0; w < workers; ++w) threads.emplace_back(work, w);
+        for (auto& thread : threads) thread.join();
+        stats.wallNanos_ = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started).count());
+        if (error) std::rethrow_exception(error);
+        return stats;
+    }
+};
@@ -1,5 +1,8 @@
-#include "orderbook.h"
+#include "Backtest.h"
+#include "MatchingEngine.h"
+#include "StatsEndpoint.h"
 #include "TerminalColors.h"
+#include "TerminalRenderer.h"
 #include <thread>
 #include <random>
 #include <iomanip>
@@ -8,10 +11,8 @@
 #include <atomic>
 #include <condition_variable>
 
-std::mutex consoleMutex;
-std::atomic<int> orderCount{0};
-std::atomic<int> tradeCount{0};
-std::chrono::time_point<std::chrono::steady_clock> lastResetTime;
+constexpr int kProducerThreads = 2;
+constexpr std::size_t kDisplayDepth = 5;
 
 class OrderGenerator {
 private:
@@ -32,14 +33,14 @@ public:
         , side_dist(0, 1)
         , type_dist(0, 4) {}
 
-    OrderPointer generateOrder() {
+    // Shared by the producer threads: the generator state and the id counter are both under mutex_
+    Order generateOrder() {
+        std::lock_guard<std::mutex> lock(mutex_);
         Price price = price_dist(gen);
         Quantity qty = qty_dist(gen);
         Side side = side_dist(gen) == 0 ? Side::BID : Side::ASK;
         OrderType type = static_cast<OrderType>(type_dist(gen));
-        
-        std::lock_guard<std::mutex> lock(mutex_);
-        return std::make_shared<Order>(
+        return Order(
             nextOrderId++,
             price,
             qty,
@@ -49,137 +50,193 @@ public:
     }
 };
 
-void displayOrderBook(const OrderBook& book) {
-    using namespace TerminalColors;
-    std::cout << CLEAR_SCREEN;
-    
-    std::cout << BOLD << "╔════════════════════════════════╗" << RESET << "\n";
-    std::cout << BOLD << "║         ORDER BOOK             ║" << RESET << "\n";
-    std::cout << BOLD << "╠════════════════════════════════╣" << RESET << "\n";
-    
-    auto asks = book.GetAsks(5);
-    std::cout << RED << "║ SELLS:                         ║" << RESET << "\n";
-    for (const auto& level : asks) {
-        std::cout << RED << "║ " << std::setw(8) << level.price_ 
-                  << " | " << std::setw(8) << level.quantity_ 
-                  << "        ║" << RESET << "\n";
+// Rates over the last second, from the engine's own counters; nothing here touches the hot path
+class MetricsDisplay {
+private:
+    std::chrono::steady_clock::time_point last_{ std::chrono::steady_clock::now() };
+    std::uint64_t lastOperations_{0};
+    std::uint64_t lastTrades_{0};
+    std::string rates_;
+    std::string latency_;
+
+    void Update(const MatchingEngine& engine, const MetricsRegistry& metrics) {
+        using namespace TerminalColors;
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_).count();
+        if (elapsed < 1.0) return;
+
+        ThreadMetricsSummary total;
+        for (const auto& summary : metrics.Summaries()) total.Merge(summary);
+        std::uint64_t operations = 0;
+        for (const auto& latency : total.latency_) operations += latency.count_;
+        std::uint64_t trades = total.tradesPerMatch_.sum_;
+        const auto& add = total.latency_[static_cast<std::size_t>(MetricOperation::Add)];
+        const auto& match = total.latency_[static_cast<std::size_t>(MetricOperation::Match)];
+
+        auto stats = engine.GetStats();
+        rates_ = BOLD + std::format("Commands/sec: {} | Trades/sec: {}", static_cast<std::uint64_t>((operations - lastOperations_) / elapsed),
+                                    static_cast<std::uint64_t>((trades - lastTrades_) / elapsed)) + RESET;
+        latency_ = std::format("Queue depth: {} | Add p50/p99: {}/{} ns | Match p50/p99: {}/{} ns | Rejected: {}", stats.queueDepth_,
+                               add.Percentile(50), add.Percentile(99), match.Percentile(50), match.Percentile(99),
+                               stats.commandsRejected_ + stats.producerRejects_);
+
+        last_ = now;
+        lastOperations_ = operations;
+        lastTrades_ = trades;
     }
-    
-    std::cout << BOLD << "╠════════════════════════════════╣" << RESET << "\n";
-    
-    auto bids = book.GetBids(5);
-    std::cout << GREEN << "║ BUYS:                          ║" << RESET << "\n";
-    for (const auto& level : bids) {
-        std::cout << GREEN << "║ " << std::setw(8) << level.price_ 
-                  << " | " << std::setw(8) << level.quantity_ 
-                  << "        ║" << RESET << "\n";
+
+public:
+    // Recomputed once a second; the rows in between repeat, so the renderer skips them
+    void AppendRows(std::vector<std::string>& rows, const MatchingEngine& engine, const MetricsRegistry& metrics) {
+        Update(engine, metrics);
+        rows.push_back(rates_);
+        rows.push_back(latency_);
     }
-    
-    std::cout << BOLD << "╚════════════════════════════════╝" << RESET << "\n";
-}
+};
 
-void displayTrade(const Trade& trade) {
-    using namespace TerminalColors;
-    try {
-        std::cout << BOLD << "TRADE: " << RESET;
-        std::cout << "Price: " << trade.GetBidTrade().price_ 
-                  << " Quantity: " << trade.GetBidTrade().quantity_ << "\n";
-    } catch (const std::exception& e) {
-        std::cerr << "Error in displayTrade: " << e.what() << std::endl;
-    } catch (...) {
-        std::cerr << "Unknown error in displayTrade" << std::endl;
+// Gateway: generates orders and hands them to the engine; never touches the book or the console
+void orderProcessingThread(MatchingEngine& engine, OrderGenerator& generator, std::atomic<bool>& running) {
+    while (running) {
+        auto order = generator.generateOrder();
+        if (!engine.Submit(Command::Add(order))) continue;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
 }
 
-void displayMetrics() {
-    using namespace TerminalColors;
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - lastResetTime).count();
-    
-    if (elapsed >= 1) {
-        std::cout << BOLD << "Orders/sec: " << orderCount.load() / elapsed
-                  << " | Trades/sec: " << tradeCount.load() / elapsed << RESET << "\n";
-        
-        orderCount.store(0);
-        tradeCount.store(0);
-        lastResetTime = now;
+// Sole consumer of the engine's outbound events; trades go to the display's lossy tape
+void marketDataThread(MatchingEngine& engine, TradeTape& tape, std::atomic<bool>& running) {
+    EngineEvent event;
+    while (running) {
+        bool any = false;
+        while (engine.PollEvent(event)) {
+            any = true;
+            if (event.type_ == EngineEventType::Trade) tape.Push(event.trade_);
+        }
+        if (!any) std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
 }
 
-void orderProcessingThread(OrderBook& book, OrderGenerator& generator, std::atomic<bool>& running) {
-    // Thread-local random generator for thread safety
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(0, 99);
-    
+// Every 100ms: the book from the engine's published snapshot, a summary of the last second's
+// trades and the metrics, drawn by rewriting only the rows that changed. Nothing here takes a
+// lock another thread waits on.
+void displayThread(const MatchingEngine& engine, const MetricsRegistry& metrics, TradeTape& tape, std::atomic<bool>& running) {
+    TerminalRenderer renderer;
+    MetricsDisplay display;
+    std::vector<std::string> rows;
+    TradeSummary second, shown;
+    auto secondStarted = std::chrono::steady_clock::now();
+
     while (running) {
-        auto order = generator.generateOrder();
-        Trades trades;
         try {
-            trades = book.AddOrder(order);
-            
-            orderCount++;
-            if (!trades.empty()) {
-                tradeCount += trades.size();
-                
-                // Display trades when they occur
-                std::lock_guard<std::mutex> lock(consoleMutex);
-                for (const auto& trade : trades) {
-                    displayTrade(trade);
-                }
+            tape.Drain([&](const Trade& trade) { second.Add(trade); });
+            auto now = std::chrono::steady_clock::now();
+            if (now - secondStarted >= std::chrono::seconds(1)) {
+                shown = second;
+                second = {};
+                secondStarted = now;
             }
+            rows.clear();
+            AppendBookRows(rows, engine.GetSnapshot(), kDisplayDepth);
+            AppendTradeRows(rows, shown, tape.Dropped());
+            display.AppendRows(rows, engine, metrics);
+            rows.push_back("Press Enter to exit...");
+            renderer.Render(rows);
         } catch (const std::exception& e) {
-            std::cerr << "Error adding order: " << e.what() << std::endl;
-            continue;
-        }
-        
-        // Use thread-safe random generation
-        if (dist(gen) == 0) {
-            std::lock_guard<std::mutex> lock(consoleMutex);
-            std::cout << "\nNew " 
-                      << (order->GetSide() == Side::BID ? "BUY" : "SELL")
-                      << " Order: Price=" << order->GetPrice()
-                      << " Qty=" << order->GetInitialQuantity() << "\n";
+            std::cerr << "Error in display thread: " << e.what() << std::endl;
+            renderer.Invalidate();
         }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
 
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+// orderbook --backtest --out DIR [--threads N] [--pin FIRST_CPU] [--ladder BASE,TICK,LEVELS]
+//                      [--no-trades] [--no-steal] FILE|DIR...
+int backtestMain(int argc, char** argv) {
+    BacktestConfig config;
+    std::vector<std::filesystem::path> paths;
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument(flag + " needs a value");
+            return argv[++i];
+        };
+        if (flag == "--out") config.outputDirectory_ = value();
+        else if (flag == "--threads") config.pool_.threads_ = std::stoul(value());
+        else if (flag == "--pin") {
+            config.pool_.pinThreads_ = true;
+            config.pool_.firstCpu_ = std::stoi(value());
+        } else if (flag == "--ladder") {
+            LadderConfig ladder{};
+            std::istringstream in{ value() };
+            char comma1 = 0, comma2 = 0;
+            in >> ladder.basePrice_ >> comma1 >> ladder.tickSize_ >> comma2 >> ladder.levels_;
+            if (!in || comma1 != ',' || comma2 != ',') throw std::invalid_argument("--ladder takes BASE,TICK,LEVELS");
+            config.ladder_ = ladder;
+        }
+        else if (flag == "--no-trades") config.writeTrades_ = false;
+        else if (flag == "--no-steal") config.pool_.stealing_ = false;
+        else paths.emplace_back(flag);
     }
+    if (config.outputDirectory_.empty() || paths.empty())
+        throw std::invalid_argument("usage: --backtest --out DIR [--threads N] [--pin FIRST_CPU] [--ladder BASE,TICK,LEVELS] [--no-trades] [--no-steal] FILE|DIR...");
+
+    auto inputs = ListOrderFiles(paths);
+    auto report = RunBacktest(config, inputs);
+    for (const auto& job : report.jobs_)
+        if (!job.error_.empty()) std::cerr << job.error_ << "\n";
+    std::cout << report.jobs_.size() << " jobs (" << report.failed_ << " failed) on " << report.pool_.workers_.size()
+              << " threads: " << report.commands_ << " commands, " << report.trades_ << " trades in "
+              << std::fixed << std::setprecision(3) << report.pool_.wallNanos_ / 1e9 << "s = "
+              << static_cast<std::uint64_t>(report.EventsPerSecond()) << " events/s, imbalance "
+              << std::setprecision(2) << report.pool_.Imbalance() << "\n"
+              << "results in " << (config.outputDirectory_ / "backtest.json").string() << "\n";
+    return report.failed_ ? 1 : 0;
 }
 
-void displayThread(OrderBook& book, std::atomic<bool>& running) {
-    lastResetTime = std::chrono::steady_clock::now();
-    
-    while (running) {
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string_view{ argv[1] } == "--backtest") {
         try {
-            std::lock_guard<std::mutex> lock(consoleMutex);
-            displayOrderBook(book);
-            displayMetrics();
+            return backtestMain(argc, argv);
         } catch (const std::exception& e) {
-            std::cerr << "Error in display thread: " << e.what() << std::endl;
-        } catch (...) {
-            std::cerr << "Unknown error in display thread" << std::endl;
+            std::cerr << e.what() << std::endl;
+            return 2;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
-}
 
-int main() {
     try {
-        OrderBook book;
+        MetricsRegistry metrics;
+        MatchingEngine engine;
+        engine.SetMetrics(&metrics);
         OrderGenerator generator;
+
+        // JSON stats: cat /tmp/orderbook-stats.json, or socat - UNIX-CONNECT:/tmp/orderbook-stats.sock
+        StatsEndpoint stats{ metrics, StatsConfig{ "/tmp/orderbook-stats.json", "/tmp/orderbook-stats.sock" } };
+        stats.Start();
         
         std::atomic<bool> running{true};
+        engine.Start();
         
-        std::thread processingThread(orderProcessingThread, std::ref(book), std::ref(generator), std::ref(running));
-        std::thread displayThreadHandle(displayThread, std::ref(book), std::ref(running));
+        std::vector<std::thread> processingThreads;
+        for (int i = 0; i < kProducerThreads; ++i) {
+            processingThreads.emplace_back(orderProcessingThread, std::ref(engine), std::ref(generator), std::ref(running));
+        }
+        TradeTape tape;
+        std::thread marketDataThreadHandle(marketDataThread, std::ref(engine), std::ref(tape), std::ref(running));
+        std::thread displayThreadHandle(displayThread, std::cref(engine), std::cref(metrics), std::ref(tape), std::ref(running));
         
-        std::cout << "Press Enter to exit..." << std::endl;
         std::cin.get();
         
         running = false;
         
-        if (processingThread.joinable()) {
-            processingThread.join();
+        for (auto& processingThread : processingThreads) {
+            if (processingThread.joinable()) {
+                processingThread.join();
+            }
+        }
+        engine.Stop();
+        
+        if (marketDataThreadHandle.joinable()) {
+            marketDataThreadHandle.join();
         }
         
         if (displayThreadHandle.joinable()) {
@@ -4,63 +4,127 @@
 #include <stdexcept>
 #include <format>
 #include <vector>
-#include <mutex>
-#include <memory>
 
+// Resting order record. The book's thread owns every order, so there is no locking; the layout
+// keeps the fields matching reads first and packs side and type into one byte, which fits an
+// order in a single 64-byte pool slot.
 class Order {
 private:
     OrderId orderid_;
     Price price_;
+
+    // intrusive links for the FIFO of the price level this order rests on
+    Order* prev_{nullptr};
+    Order* next_{nullptr};
+    friend class OrderList;
+
     Quantity initialQuantity_;
     Quantity remainingQuantity_;
-    Side side_;
-    OrderType ordertype_;
-    std::mutex mutex_;
-    
+    std::uint8_t side_ : 1;
+    std::uint8_t ordertype_ : 3;
+    Owner owner_;       // what a mass cancel by owner matches on
+    Price stopPrice_;   // Stop and StopLimit only; read when the order is parked or released
+
 public:
-    Order(OrderId id, Price p, Quantity q, Side s, OrderType type)
+    Order(OrderId id, Price p, Quantity q, Side s, OrderType type, Price stopPrice = 0, Owner owner = 0)
         : orderid_{ id }
         , price_{ p }
         , initialQuantity_{ q }
         , remainingQuantity_{ q }
-        , side_{ s }
-        , ordertype_{ type }
+        , side_{ static_cast<std::uint8_t>(s) }
+        , ordertype_{ static_cast<std::uint8_t>(type) }
+        , owner_{ owner }
+        , stopPrice_{ stopPrice }
     {}
-    
+
     OrderId GetOrderId() const { return orderid_; }
     Price GetPrice() const { return price_; }
     Quantity GetInitialQuantity() const { return initialQuantity_; }
     Quantity GetRemainingQuantity() const { return remainingQuantity_; }
-    Side GetSide() const { return side_; }
-    OrderType GetOrderType() const { return ordertype_; }
+    Side GetSide() const { return static_cast<Side>(side_); }
+    OrderType GetOrderType() const { return static_cast<OrderType>(ordertype_); }
+    Price GetStopPrice() const { return stopPrice_; }
+    Owner GetOwner() const { return owner_; }
+    bool IsStop() const { return GetOrderType() == OrderType::Stop || GetOrderType() == OrderType::StopLimit; }
     bool IsFilled() const { return remainingQuantity_ == 0; }
-    
+
     void FillOrder(Quantity quantity) {
-        std::lock_guard<std::mutex> lock(mutex_);
         if (quantity > GetRemainingQuantity())
             throw std::logic_error(std::format("Order ({}) cannot be filled for more than its remaining quantity.", GetOrderId()));
         remainingQuantity_ -= quantity;
     }
 
+    // Amend down: takes quantity off both the initial and remaining size, so the executed quantity is unchanged
+    void ReduceQuantity(Quantity quantity) {
+        if (quantity >= GetRemainingQuantity())
+            throw std::logic_error(std::format("Order ({}) cannot be reduced by its whole remaining quantity.", GetOrderId()));
+        initialQuantity_ -= quantity;
+        remainingQuantity_ -= quantity;
+    }
+
     void ToGoodTillCancel(Price price) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (ordertype_ == OrderType::Market) {
+        if (GetOrderType() == OrderType::Market) {
             throw std::logic_error(std::format("Order ({}) cannot be adjusted; market orders cannot become GoodTillCancel.", orderid_));
         }
         price_ = price;
-        ordertype_ = OrderType::GoodTillCancel;
+        ordertype_ = static_cast<std::uint8_t>(OrderType::GoodTillCancel);
     }
 };
 
-using OrderPointer = std::shared_ptr<Order>;
-using OrderPointers = std::vector<OrderPointer>;
+static_assert(sizeof(Order) <= 64, "an order must fit one cache line");
+
+// Handle to an order owned by the book's OrderPool
+using OrderPointer = Order*;
+
+// Time-priority queue of the orders resting at one price, linked through the orders themselves.
+// Push to the back, pop from the front and unlinking any order are all O(1), and nothing
+// a caller holds is invalidated by operations on other orders.
+class OrderList {
+private:
+    Order* head_{nullptr};
+    Order* tail_{nullptr};
+    std::size_t size_{0};
+
+public:
+    bool Empty() const { return head_ == nullptr; }
+    std::size_t Size() const { return size_; }
+    Order* Front() const { return head_; }
+    Order* Back() const { return tail_; }
+
+    static Order* Next(const Order* order) { return order->next_; }
+
+    void PushBack(Order* order) {
+        order->prev_ = tail_;
+        order->next_ = nullptr;
+        if (tail_) tail_->next_ = order;
+        else head_ = order;
+        tail_ = order;
+        ++size_;
+    }
+
+    void Erase(Order* order) {
+        if (order->prev_) order->prev_->next_ = order->next_;
+        else head_ = order->next_;
+        if (order->next_) order->next_->prev_ = order->prev_;
+        else tail_ = order->prev_;
+        order->prev_ = order->next_ = nullptr;
+        --size_;
+    }
+
+    void PopFront() { Erase(head_); }
+
+    // Forgets every order at once; the caller has already released them
+    void Clear() {
+        head_ = tail_ = nullptr;
+        size_ = 0;
+    }
+};
 class OrderModify {
     private:
         OrderId orderId_;
         Price newPrice_;
         Quantity newQuantity_;
         Side side_;
-        std::mutex mutex_;
     public:
         OrderModify(OrderId orderId, Price newPrice, Quantity newQuantity, Side side) 
             : orderId_(orderId)
@@ -68,7 +132,6 @@ class OrderModify {
             , newQuantity_(newQuantity)
             , side_(side)
         {
-            std::lock_guard<std::mutex> lock(mutex_);
             if (newQuantity_ <= 0) {
                 throw std::invalid_argument("Quantity must be positive");
             }
@@ -82,19 +145,19 @@ class OrderModify {
         Quantity GetNewQuantity() const { return newQuantity_; }
         Side GetSide() const { return side_; }
 
-        OrderPointer ToOrderPointer(OrderType orderType) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            return std::make_shared<Order>(
+        Order ToOrder(OrderType orderType, Owner owner = 0) const {
+            return Order(
                 GetOrderId(),
                 GetNewPrice(),
                 GetNewQuantity(),
                 GetSide(),
-                orderType
+                orderType,
+                0,
+                owner
             );
         }
 
         void Modify(Price newPrice, Quantity newQuantity) {
-            std::lock_guard<std::mutex> lock(mutex_);
             if (newQuantity <= 0) {
                 throw std::invalid_argument("Quantity must be positive");
             }
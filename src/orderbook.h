@@ -1,85 +1,385 @@
-#include <unordered_map>
-#include <map>
-#include <list>
+#pragma once
+#include <array>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+#include "Command.h"
+#include "MarketData.h"
 #include "order.h"
+#include "OrderEvents.h"
+#include "OrderIndex.h"
+#include "OrderPool.h"
+#include "PriceLevels.h"
+#include "TimerWheel.h"
 #include "Trade.h"
 #include "using.h"
 
-class OrderBook {
+// Adds go through matching kernels specialized per aggressor side and order type. Build with
+// -DORDERBOOK_MATCH_KERNELS=0 for the generic rest-then-uncross path they replaced, which stays
+// as the reference the kernels are checked and benchmarked against.
+#ifndef ORDERBOOK_MATCH_KERNELS
+#define ORDERBOOK_MATCH_KERNELS 1
+#endif
+
+constexpr bool kMatchKernels = ORDERBOOK_MATCH_KERNELS != 0;
+constexpr std::size_t kOrderTypes = static_cast<std::size_t>(OrderType::Market) + 1;
+
+// What an incoming order of type T does once it crosses the book
+template <OrderType T>
+struct MatchPolicy {
+    static constexpr bool kLimited = T != OrderType::Market;          // stops at its own price
+    static constexpr bool kSweeps = T != OrderType::FillAndKill;      // goes on past the best opposite level
+    static constexpr bool kRestsRemainder = T != OrderType::FillAndKill && T != OrderType::FillOrKill;
+    static constexpr OrderType kRestingType = T == OrderType::Market ? OrderType::GoodTillCancel : T;
+};
+
+// When GoodForDay orders expire: at close_ and every period_ after it (period_ 0 = that close only)
+struct SessionSchedule {
+    Timestamp close_{22ll * 3600 * 1'000'000'000};   // 22:00 UTC
+    Timestamp period_{24ll * 3600 * 1'000'000'000};
+};
+
+// Reusable output of OrderBook::ProcessBatch. Trades and level deltas are appended in command
+// order; tradeEnds_[i] is the end offset in trades_ of command i's fills, so command i traded
+// trades_[tradeEnds_[i-1], tradeEnds_[i]).
+struct BatchResult {
+    Trades trades_;
+    LevelUpdates levelUpdates_;
+    std::vector<std::uint32_t> tradeEnds_;
+    std::size_t collapsed_{0};   // add/cancel pairs that never touched the book
+    std::size_t rejected_{0};    // commands that threw
+
+    // Keeps the capacity, so a result reused across batches stops allocating once warm
+    void Clear() {
+        trades_.clear();
+        levelUpdates_.clear();
+        tradeEnds_.clear();
+        collapsed_ = 0;
+        rejected_ = 0;
+    }
+};
+
+// Every order's lifecycle is reported to Listener as it happens (see OrderEvents.h), with no
+// intermediate containers; OrderBook is the listener-less book. The Trades-returning calls are an
+// adapter that also collects the fills of one call into a vector.
+template <OrderListener Listener = NullOrderListener>
+class BasicOrderBook {
     private:
-        struct OrderEntry {
-            OrderPointer order_{nullptr};
-            OrderPointers::iterator location_;
+
+        Listener listener_;
+        Trades* trades_{nullptr};   // fills are appended here too while a Trades call runs
+        OrderPool pool_;
+        PriceLevels<Side::BID> _bids;
+        PriceLevels<Side::ASK> _asks;
+        OrderIndex orders_;   // the order's own links are its handle into the level FIFO; storage belongs to pool_
+
+        // Pending Stop/StopLimit orders, queued by stop price with the one the next trade reaches
+        // first at the front: buy stops lowest first, sell stops highest first. They are pooled
+        // and indexed like resting orders but never seen by matching. Always map-backed, so a
+        // dense book does not pay for two more ladders.
+        PriceLevels<Side::ASK> buyStops_;
+        PriceLevels<Side::BID> sellStops_;
+        std::size_t stopCount_{0};
+        std::optional<Price> lastPrice_;   // price of the last trade, what stops trigger on
+        bool releasing_{false};            // inside ReleaseStops: released orders were accepted when parked
+
+        // L2 delta feed: every level change gets the next sequence number, sink or not
+        LevelUpdates* levelUpdates_{nullptr};
+        std::uint64_t sequence_{0};
+
+        // GoodForDay expiry: ids keyed by the session close they expire at; the clock only moves
+        // through AdvanceClock so replaying the same commands expires the same orders
+        TimerWheel<OrderId> dayOrders_;
+        SessionSchedule session_;
+        Timestamp clock_{0};
+
+        // ProcessBatch scratch, kept to avoid per-batch allocation
+        static constexpr std::size_t kCollapseWindow = 16;
+        static constexpr std::uint32_t kNoPartner = static_cast<std::uint32_t>(-1);
+        std::vector<std::uint32_t> batchPartners_;
+        std::vector<std::uint8_t> batchSkipped_;
+
+        template <OrderListener> friend class BasicOrderBook;
+
+        // keeps the aggregate remaining quantity of a level in step with its orders
+        template <Side S>
+        void UpdateLevelData(PriceLevel& level, Quantity quantity, bool isAdd) {
+            if (isAdd) Levels<S>().AddQuantity(level, quantity);
+            else Levels<S>().RemoveQuantity(level, quantity);
+        }
+
+        void UpdateLevelData(Side side, PriceLevel& level, Quantity quantity, bool isAdd) {
+            if (side == Side::BID) UpdateLevelData<Side::BID>(level, quantity, isAdd);
+            else UpdateLevelData<Side::ASK>(level, quantity, isAdd);
+        }
+
+        void EmitLevelUpdate(Side side, Price price, Quantity quantity) {
+            ++sequence_;
+            if (levelUpdates_) levelUpdates_->push_back({price, quantity, side, sequence_});
+        }
+
+        // Points trades_ at a caller's vector for the length of one call
+        class TradeCapture {
+        private:
+            BasicOrderBook& book_;
+            Trades* previous_;
+
+        public:
+            TradeCapture(BasicOrderBook& book, Trades& trades)
+                : book_{ book }
+                , previous_{ book.trades_ }
+            {
+                book.trades_ = &trades;
+            }
+
+            ~TradeCapture() { book_.trades_ = previous_; }
+
+            TradeCapture(const TradeCapture&) = delete;
+            TradeCapture& operator=(const TradeCapture&) = delete;
         };
 
-        std::map<Price, OrderPointers, std::greater<Price>> _bids;
-        std::map<Price, OrderPointers, std::less<Price>> _asks;
-        std::unordered_map<OrderId, OrderEntry> orders_;
+        static OrderStatus StatusOf(const Order& order) {
+            return order.GetRemainingQuantity() == order.GetInitialQuantity() ? OrderStatus::NEW : OrderStatus::PARTIALLY_FILLED;
+        }
 
-        std::map<Price, LevelInfo> data_;
+        void ReportAccept(OrderId orderId, Side side, OrderType type, Price price, Quantity quantity) {
+            if (releasing_) return;
+            listener_.OnAccept(OrderEvent{ orderId, 0, price, quantity, quantity, side, type, OrderStatus::NEW });
+        }
 
-        void UpdateDataMap(Price price, Quantity quantity, Side side, bool isAdd) {
-            if (isAdd) {
-                data_[price].price_ = price;
-                data_[price].quantity_ += quantity;
-            } else {
-                data_[price].quantity_ -= quantity;
-                if (data_[price].quantity_ == 0) {
-                    data_.erase(price);
-                }
+        // A released stop that cannot trade (a Stop into an empty side) was live, so it is cancelled
+        void ReportReject(OrderId orderId, Side side, OrderType type, Price price, Quantity quantity, RejectReason reason) {
+            if (releasing_) {
+                ReportCancel(orderId, side, type, price, quantity);
+                return;
             }
+            listener_.OnReject(OrderEvent{ orderId, 0, price, quantity, 0, side, type, OrderStatus::REJECTED }, reason);
+        }
+
+        void ReportReject(const Order& order, RejectReason reason) {
+            ReportReject(order.GetOrderId(), order.GetSide(), order.GetOrderType(), order.GetPrice(), order.GetRemainingQuantity(), reason);
+        }
+
+        // A cancel or modify of an id that is not on the book: only what the request carried is real
+        void ReportUnknown(OrderId orderId, Side side, Price price, Quantity quantity) {
+            OrderEvent event{ orderId, 0, price, quantity, 0, side, OrderType::GoodTillCancel, OrderStatus::REJECTED };
+            event.known_ = false;
+            listener_.OnReject(event, RejectReason::UnknownOrderId);
+        }
+
+        void ReportFill(OrderId orderId, Side side, OrderType type, Price price, Quantity quantity, Quantity remaining, OrderId contraOrderId) {
+            if (remaining == 0) listener_.OnFill(OrderEvent{ orderId, contraOrderId, price, quantity, 0, side, type, OrderStatus::FILLED });
+            else listener_.OnPartialFill(OrderEvent{ orderId, contraOrderId, price, quantity, remaining, side, type, OrderStatus::PARTIALLY_FILLED });
+        }
+
+        void ReportFill(const Order& order, Price price, Quantity quantity, OrderId contraOrderId) {
+            ReportFill(order.GetOrderId(), order.GetSide(), order.GetOrderType(), price, quantity, order.GetRemainingQuantity(), contraOrderId);
+        }
+
+        // Whatever remains of an order that is leaving the book
+        void ReportCancel(OrderId orderId, Side side, OrderType type, Price price, Quantity quantity) {
+            listener_.OnCancel(OrderEvent{ orderId, 0, price, quantity, 0, side, type, OrderStatus::CANCELLED });
+        }
+
+        void RecordTrade(OrderId bidOrderId, OrderId askOrderId, Price bidPrice, Price askPrice, Quantity quantity, Side aggressor) {
+            if (trades_) trades_->push_back(Trade{ bidOrderId, askOrderId, bidPrice, askPrice, quantity, aggressor });
+        }
+
+        // Rejects and then throws as GetOrCreate would if side S cannot hold price
+        template <Side S>
+        void CheckPrice(const Order& order, Price price) {
+            if (Levels<S>().Accepts(price)) return;
+            ReportReject(order, RejectReason::InvalidPrice);
+            Levels<S>().CheckPrice(price);
+        }
+
+        static constexpr Side Opposite(Side side) { return side == Side::BID ? Side::ASK : Side::BID; }
+
+        template <Side S>
+        PriceLevels<S>& Levels() {
+            if constexpr (S == Side::BID) return _bids;
+            else return _asks;
+        }
+
+        template <Side S>
+        const PriceLevels<S>& Levels() const {
+            if constexpr (S == Side::BID) return _bids;
+            else return _asks;
+        }
+
+        // Whether price on side S reaches the best level of the other side
+        template <Side S>
+        bool Crosses(Price price) const {
+            const auto& other = Levels<Opposite(S)>();
+            if (other.Empty()) return false;
+            if constexpr (S == Side::BID) return price >= other.BestPrice();
+            else return price <= other.BestPrice();
+        }
+
+        bool CanMatch(Price price, Side side) const {
+            return side == Side::BID ? Crosses<Side::BID>(price) : Crosses<Side::ASK>(price);
+        }
+
+        // Resting quantity at acceptable prices on the other side covers quantity
+        template <Side S>
+        bool CanFullyFill(Price price, Quantity quantity) const {
+            return Crosses<S>(price) && Levels<Opposite(S)>().Covers(price, quantity);
+        }
+
+        bool CanFullyFill(Price price, Side side, Quantity quantity) const {
+            return side == Side::BID ? CanFullyFill<Side::BID>(price, quantity) : CanFullyFill<Side::ASK>(price, quantity);
         }
 
-        bool CanMatch(Price price, Side side) {
-            if (side == Side::BID) {
-                if (_asks.empty()) return false;
-                const auto& [bestAsk, _] = *_asks.begin();
-                return price >= bestAsk;
+        Timestamp NextSessionClose() const {
+            if (clock_ < session_.close_) return session_.close_;
+            if (session_.period_ <= 0) return std::numeric_limits<Timestamp>::max();
+            return session_.close_ + ((clock_ - session_.close_) / session_.period_ + 1) * session_.period_;
+        }
+
+        // Puts a new order at the back of its level on side S; the caller emits the level delta
+        template <Side S>
+        PriceLevel& Rest(OrderId orderId, Price price, Quantity quantity, OrderType type, Owner owner) {
+            auto& level = Levels<S>().GetOrCreate(price);
+            OrderPointer resting = pool_.Acquire(orderId, price, quantity, S, type, 0, owner);
+            level.orders_.PushBack(resting);
+            UpdateLevelData<S>(level, quantity, true);
+            orders_.Insert(orderId, resting);
+            if (type == OrderType::GoodForDay) dayOrders_.Schedule(NextSessionClose(), orderId);
+            return level;
+        }
+
+        // Fills an incoming order on side S, which must cross, against the best opposite levels
+        // and returns the quantity left. The order never rests while it trades, so only the
+        // opposite levels get deltas, one per level taken; the caller emits the order's own level
+        // if a remainder rests. A delta consumer never sees the book crossed.
+        template <Side S, OrderType T>
+        Quantity Sweep(OrderId orderId, Price price, Quantity quantity) {
+            auto& other = Levels<Opposite(S)>();
+            do {
+                Price levelPrice = other.BestPrice();
+                if constexpr (MatchPolicy<T>::kLimited) {
+                    if (S == Side::BID ? levelPrice > price : levelPrice < price) break;
+                }
+                PriceLevel& level = other.BestLevel();
+                OrderList& queue = level.orders_;
+                do {
+                    Order* resting = queue.Front();
+                    Quantity quantityFilled = std::min(quantity, resting->GetRemainingQuantity());
+                    resting->FillOrder(quantityFilled);
+                    quantity -= quantityFilled;
+                    UpdateLevelData<Opposite(S)>(level, quantityFilled, false);
+                    lastPrice_ = levelPrice;
+                    if constexpr (S == Side::BID) {
+                        RecordTrade(orderId, resting->GetOrderId(), price, levelPrice, quantityFilled, S);
+                        ReportFill(orderId, S, T, levelPrice, quantityFilled, quantity, resting->GetOrderId());
+                        ReportFill(*resting, levelPrice, quantityFilled, orderId);
+                    } else {
+                        RecordTrade(resting->GetOrderId(), orderId, levelPrice, price, quantityFilled, S);
+                        ReportFill(*resting, levelPrice, quantityFilled, orderId);
+                        ReportFill(orderId, S, T, levelPrice, quantityFilled, quantity, resting->GetOrderId());
+                    }
+                    if (resting->IsFilled()) {
+                        queue.PopFront();
+                        orders_.Erase(resting->GetOrderId());
+                        pool_.Release(resting);
+                    }
+                } while (quantity > 0 && !queue.Empty());
+
+                EmitLevelUpdate(Opposite(S), levelPrice, level.quantity_);
+                if (queue.Empty()) other.Erase(levelPrice);
+                if constexpr (!MatchPolicy<T>::kSweeps) break;
+            } while (quantity > 0 && !other.Empty());
+            return quantity;
+        }
+
+        // The add kernel for one aggressor side and order type; AddOrderInternal picks it
+        template <Side S, OrderType T>
+        void AddOrderAs(const Order& order) {
+            const auto& other = Levels<Opposite(S)>();
+            OrderId orderId = order.GetOrderId();
+            Price price = order.GetPrice();
+            Quantity quantity = order.GetRemainingQuantity();
+            if constexpr (T == OrderType::Market) {
+                if (other.Empty()) {
+                    ReportReject(order, RejectReason::NoLiquidity);
+                    return;
+                }
+                price = other.WorstPrice();
+            } else if constexpr (T == OrderType::FillAndKill) {
+                if (!Crosses<S>(price)) {
+                    ReportReject(order, RejectReason::NoLiquidity);
+                    return;
+                }
+            } else if constexpr (T == OrderType::FillOrKill) {
+                if (!CanFullyFill<S>(price, quantity)) {
+                    ReportReject(order, RejectReason::InsufficientLiquidity);
+                    return;
+                }
+            } else if (!Crosses<S>(price)) {
+                CheckPrice<S>(order, price);
+                PriceLevel& level = Rest<S>(orderId, price, quantity, T, order.GetOwner());
+                ReportAccept(orderId, S, T, price, quantity);
+                EmitLevelUpdate(S, price, level.quantity_);
+                return;
+            }
+
+            CheckPrice<S>(order, price);
+            ReportAccept(orderId, S, T, price, quantity);
+            quantity = Sweep<S, T>(orderId, price, quantity);
+            if (quantity == 0) return;
+            // the level was empty before: the book was not crossed
+            if constexpr (MatchPolicy<T>::kRestsRemainder) {
+                PriceLevel& level = Rest<S>(orderId, price, quantity, MatchPolicy<T>::kRestingType, order.GetOwner());
+                EmitLevelUpdate(S, price, level.quantity_);
             } else {
-                if (_bids.empty()) return false;
-                const auto& [bestBid, _] = *_bids.begin();
-                return price <= bestBid;
+                ReportCancel(orderId, S, T, price, quantity);   // the unfilled part; its level was never shown
             }
         }
 
-        Trades MatchOrder() {
-            Trades trades;
+        template <Side S>
+        static constexpr std::array<void (BasicOrderBook::*)(const Order&), kOrderTypes> AddKernels() {
+            return {
+                &BasicOrderBook::AddOrderAs<S, OrderType::GoodTillCancel>,
+                &BasicOrderBook::AddOrderAs<S, OrderType::FillAndKill>,
+                &BasicOrderBook::AddOrderAs<S, OrderType::FillOrKill>,
+                &BasicOrderBook::AddOrderAs<S, OrderType::GoodForDay>,
+                &BasicOrderBook::AddOrderAs<S, OrderType::Market>,
+            };
+        }
+
+        // Generic path (ORDERBOOK_MATCH_KERNELS=0): crosses the book until it is no longer
+        // crossed. The incoming order is reported with the type it was submitted as. It is alone
+        // on the best level of incomingSide while it trades, and that level gets no deltas here:
+        // the caller emits it once, if anything rests. A FillAndKill stops after one round.
+        void MatchOrder(OrderId incomingId, OrderType incomingType, Side incomingSide) {
+            auto typeOf = [&](const Order& order) { return order.GetOrderId() == incomingId ? incomingType : order.GetOrderType(); };
 
             while (true) {
-                if (_bids.empty() || _asks.empty()) break;
+                if (_bids.Empty() || _asks.Empty()) break;
 
                 // Get the best bid and ask
-                auto bidIt = _bids.begin();
-                auto askIt = _asks.begin();
-                
-                if (bidIt == _bids.end() || askIt == _asks.end()) break;
-                
-                Price bidPrice = bidIt->first;
-                Price askPrice = askIt->first;
+                Price bidPrice = _bids.BestPrice();
+                Price askPrice = _asks.BestPrice();
                 
                 // Check if they can match
                 if (bidPrice < askPrice) break;
 
-                auto& bids = bidIt->second;
-                auto& asks = askIt->second;
+                auto& bidLevel = _bids.BestLevel();
+                auto& askLevel = _asks.BestLevel();
+                auto& bids = bidLevel.orders_;
+                auto& asks = askLevel.orders_;
                 
                 // Safety check for empty containers
-                if (bids.empty() || asks.empty()) {
-                    if (bids.empty()) _bids.erase(bidPrice);
-                    if (asks.empty()) _asks.erase(askPrice);
+                if (bids.Empty() || asks.Empty()) {
+                    if (bids.Empty()) _bids.Erase(bidPrice);
+                    if (asks.Empty()) _asks.Erase(askPrice);
                     continue;
                 }
 
-                while (!bids.empty() && !asks.empty()) {
-                    auto bid = bids.front();
-                    auto ask = asks.front();
-                    
-                    // Safety check for null pointers
-                    if (!bid || !ask) {
-                        if (!bid) bids.erase(bids.begin());
-                        if (!ask) asks.erase(asks.begin());
-                        continue;
-                    }
+                while (!bids.Empty() && !asks.Empty()) {
+                    Order* bid = bids.Front();
+                    Order* ask = asks.Front();
                     
                     Quantity quantity = std::min(bid->GetRemainingQuantity(), ask->GetRemainingQuantity());
 
@@ -88,25 +388,29 @@ class OrderBook {
                         bid->FillOrder(quantity);
                         ask->FillOrder(quantity);
                         
-                        // Update data map if needed
-                        UpdateDataMap(bidPrice, quantity, Side::BID, false);
-                        UpdateDataMap(askPrice, quantity, Side::ASK, false);
+                        // Keep level aggregates in step
+                        UpdateLevelData<Side::BID>(bidLevel, quantity, false);
+                        UpdateLevelData<Side::ASK>(askLevel, quantity, false);
                         
-                        // Create trade record
-                        trades.push_back(Trade{
-                            TradeInfo{bid->GetOrderId(), bidPrice, quantity},
-                            TradeInfo{ask->GetOrderId(), askPrice, quantity}
-                        });
+                        // Create trade record; it executes at the resting order's price
+                        Side aggressor = bid->GetOrderId() == incomingId ? Side::BID : Side::ASK;
+                        RecordTrade(bid->GetOrderId(), ask->GetOrderId(), bidPrice, askPrice, quantity, aggressor);
+                        Price price = aggressor == Side::BID ? askPrice : bidPrice;
+                        lastPrice_ = price;
+                        ReportFill(bid->GetOrderId(), Side::BID, typeOf(*bid), price, quantity, bid->GetRemainingQuantity(), ask->GetOrderId());
+                        ReportFill(ask->GetOrderId(), Side::ASK, typeOf(*ask), price, quantity, ask->GetRemainingQuantity(), bid->GetOrderId());
                         
-                        // Remove filled orders
+                        // Remove filled orders and hand their slots back to the pool
                         if (bid->IsFilled()) {
-                            bids.erase(bids.begin());
-                            orders_.erase(bid->GetOrderId());
+                            bids.PopFront();
+                            orders_.Erase(bid->GetOrderId());
+                            pool_.Release(bid);
                         }
                         
                         if (ask->IsFilled()) {
-                            asks.erase(asks.begin());
-                            orders_.erase(ask->GetOrderId());
+                            asks.PopFront();
+                            orders_.Erase(ask->GetOrderId());
+                            pool_.Release(ask);
                         }
                     } catch (const std::exception& e) {
                         std::cerr << "Error during order matching: " << e.what() << std::endl;
@@ -114,116 +418,748 @@ class OrderBook {
                     }
                 }
 
-                // Clean up empty price levels
-                if (bids.empty()) {
-                    _bids.erase(bidPrice);
-                    data_.erase(bidPrice);
+                // One delta for the resting level this round touched, with its final quantity
+                if (incomingSide == Side::BID) EmitLevelUpdate(Side::ASK, askPrice, askLevel.quantity_);
+                else EmitLevelUpdate(Side::BID, bidPrice, bidLevel.quantity_);
+
+                // Clean up empty price levels (the level must not be touched once erased)
+                bool bidsDone = bids.Empty();
+                bool asksDone = asks.Empty();
+                if (bidsDone) _bids.Erase(bidPrice);
+                if (asksDone) _asks.Erase(askPrice);
+
+                // A FillAndKill only takes the best level; the caller cancels what is left
+                if (incomingType == OrderType::FillAndKill) break;
+            }
+        }
+
+        // publish is false only for a level no delta has shown yet
+        template <Side S>
+        void RemoveOrder(Order* order, bool publish = true) {
+            auto& levels = Levels<S>();
+            auto* level = levels.Find(order->GetPrice());
+            UpdateLevelData<S>(*level, order->GetRemainingQuantity(), false);
+            if (publish) EmitLevelUpdate(S, order->GetPrice(), level->quantity_);
+            level->orders_.Erase(order);
+            if (level->Empty()) levels.Erase(order->GetPrice());
+            ReportCancel(order->GetOrderId(), S, order->GetOrderType(), order->GetPrice(), order->GetRemainingQuantity());
+            pool_.Release(order);
+        }
+
+        // False if orderId is not on the book
+        bool CancelOrderInternal(OrderId orderId, bool publish = true) {
+            OrderPointer order = orders_.Erase(orderId);
+            if (!order) return false;
+            if (order->IsStop()) CancelStop(order);
+            else if (order->GetSide() == Side::BID) RemoveOrder<Side::BID>(order, publish);
+            else RemoveOrder<Side::ASK>(order, publish);
+            return true;
+        }
+
+        void CancelOrRejectInternal(OrderId orderId) {
+            if (!CancelOrderInternal(orderId))
+                ReportUnknown(orderId, Side::BID, 0, 0);
+        }
+
+        // Trigger levels for stops on side S: buy stops are queued like asks, sell stops like bids
+        template <Side S>
+        auto& Stops() {
+            if constexpr (S == Side::BID) return buyStops_;
+            else return sellStops_;
+        }
+
+        template <Side S>
+        void ParkStop(OrderPointer stop) {
+            auto& level = Stops<S>().GetOrCreate(stop->GetStopPrice());
+            level.orders_.PushBack(stop);
+            Stops<S>().AddQuantity(level, stop->GetRemainingQuantity());
+            orders_.Insert(stop->GetOrderId(), stop);
+            ++stopCount_;
+        }
+
+        // Takes a stop off its trigger level; the caller still owns its slot and index entry
+        template <Side S>
+        void UnparkStop(Order* stop) {
+            auto& stops = Stops<S>();
+            auto* level = stops.Find(stop->GetStopPrice());
+            stops.RemoveQuantity(*level, stop->GetRemainingQuantity());
+            level->orders_.Erase(stop);
+            if (level->Empty()) stops.Erase(stop->GetStopPrice());
+            --stopCount_;
+        }
+
+        void CancelStop(Order* stop) {
+            if (stop->GetSide() == Side::BID) UnparkStop<Side::BID>(stop);
+            else UnparkStop<Side::ASK>(stop);
+            ReportCancel(stop->GetOrderId(), stop->GetSide(), stop->GetOrderType(), stop->GetPrice(), stop->GetRemainingQuantity());
+            pool_.Release(stop);
+        }
+
+        // A StopLimit's limit price is checked now, so the order cannot fail validation once it
+        // fires. A stop the last trade has already reached fires at once.
+        void AddStop(const Order& order) {
+            Side side = order.GetSide();
+            if (order.GetOrderType() == OrderType::StopLimit) {
+                if (side == Side::BID) CheckPrice<Side::BID>(order, order.GetPrice());
+                else CheckPrice<Side::ASK>(order, order.GetPrice());
+            }
+            ReportAccept(order.GetOrderId(), side, order.GetOrderType(), order.GetPrice(), order.GetRemainingQuantity());
+            OrderPointer stop = pool_.Acquire(order.GetOrderId(), order.GetPrice(), order.GetRemainingQuantity(), side,
+                order.GetOrderType(), order.GetStopPrice(), order.GetOwner());
+            if (side == Side::BID) ParkStop<Side::BID>(stop);
+            else ParkStop<Side::ASK>(stop);
+            ReleaseStops();
+        }
+
+        // The pending stop the last trade has reached, nearest trigger and then oldest first;
+        // nullptr once none is
+        OrderPointer NextTriggeredStop() {
+            if (!buyStops_.Empty() && buyStops_.BestPrice() <= *lastPrice_) return buyStops_.BestLevel().orders_.Front();
+            if (!sellStops_.Empty() && sellStops_.BestPrice() >= *lastPrice_) return sellStops_.BestLevel().orders_.Front();
+            return nullptr;
+        }
+
+        // Fires every stop the last trade has reached. Each is added as its Market or
+        // GoodTillCancel self under the same id; its trades can move the last price on to further
+        // stops, which the same loop picks up, so a cascade runs iteratively however long it is.
+        // Only the stops that fire are touched: O(1) each plus the trigger level erase.
+        void ReleaseStops() {
+            if (releasing_ || stopCount_ == 0 || !lastPrice_) return;
+            releasing_ = true;
+            try {
+                while (OrderPointer stop = NextTriggeredStop()) {
+                    if (stop->GetSide() == Side::BID) UnparkStop<Side::BID>(stop);
+                    else UnparkStop<Side::ASK>(stop);
+                    orders_.Erase(stop->GetOrderId());
+                    Order released{ stop->GetOrderId(), stop->GetPrice(), stop->GetRemainingQuantity(), stop->GetSide(),
+                        stop->GetOrderType() == OrderType::Stop ? OrderType::Market : OrderType::GoodTillCancel, 0, stop->GetOwner() };
+                    pool_.Release(stop);
+                    AddOrderInternal(released);
                 }
+            } catch (...) {
+                releasing_ = false;
+                throw;
+            }
+            releasing_ = false;
+        }
 
-                if (asks.empty()) {
-                    _asks.erase(askPrice);
-                    data_.erase(askPrice);
+        // One table lookup per order picks the kernel for its side and type
+        void AddOrderInternal(const Order& order) {
+            if (orders_.Contains(order.GetOrderId())) {
+                ReportReject(order, RejectReason::DuplicateOrderId);
+                return;
+            }
+            if (order.IsStop()) {
+                AddStop(order);
+                return;
+            }
+            auto type = static_cast<std::size_t>(order.GetOrderType());
+            if (type >= kOrderTypes) {
+                ReportReject(order, RejectReason::InvalidOrderType);
+                throw std::invalid_argument(std::format("Order ({}) has an unknown order type.", order.GetOrderId()));
+            }
+            if constexpr (kMatchKernels) {
+                static_assert(static_cast<int>(Side::ASK) == 0 && static_cast<int>(Side::BID) == 1);
+                static constexpr std::array<void (BasicOrderBook::*)(const Order&), kOrderTypes> kernels[2] = {
+                    AddKernels<Side::ASK>(),
+                    AddKernels<Side::BID>(),
+                };
+                (this->*kernels[static_cast<std::size_t>(order.GetSide())][type])(order);
+            } else {
+                AddOrderGeneric(order);
+            }
+            ReleaseStops();
+        }
+
+        void AddOrderGeneric(const Order& order) {
+            Side side = order.GetSide();
+            Price price = order.GetPrice();
+            OrderType type = order.GetOrderType();
+            switch (type) {
+            case OrderType::Market:
+                if (side == Side::BID ? _asks.Empty() : _bids.Empty()) {
+                    ReportReject(order, RejectReason::NoLiquidity);
+                    return;
+                }
+                price = side == Side::BID ? _asks.WorstPrice() : _bids.WorstPrice();
+                type = OrderType::GoodTillCancel;
+                break;
+            case OrderType::FillAndKill:
+                if (!CanMatch(price, side)) {
+                    ReportReject(order, RejectReason::NoLiquidity);
+                    return;
+                }
+                break;
+            case OrderType::FillOrKill:
+                if (!CanFullyFill(price, side, order.GetRemainingQuantity())) {
+                    ReportReject(order, RejectReason::InsufficientLiquidity);
+                    return;
                 }
+                break;
+            case OrderType::GoodTillCancel:
+            case OrderType::GoodForDay:
+            case OrderType::Stop:        // parked by AddStop, never matched directly
+            case OrderType::StopLimit:
+                break;
+            }
 
-                // Handle FillAndKill orders
-                if (!bids.empty()) {
-                    auto& order = bids.front();
-                    if (order && order->GetOrderType() == OrderType::FillAndKill) {
-                        CancelOrder(order->GetOrderId());
-                    }
+            if (side == Side::BID) CheckPrice<Side::BID>(order, price);
+            else CheckPrice<Side::ASK>(order, price);
+            ReportAccept(order.GetOrderId(), side, order.GetOrderType(), price, order.GetRemainingQuantity());
+            bool crosses = CanMatch(price, side);
+
+            auto& level = side == Side::BID
+                ? _bids.GetOrCreate(price)
+                : _asks.GetOrCreate(price);
+
+            OrderPointer resting = pool_.Acquire(
+                order.GetOrderId(),
+                price,
+                order.GetRemainingQuantity(),
+                side,
+                type,
+                0,
+                order.GetOwner()
+            );
+            level.orders_.PushBack(resting);
+            UpdateLevelData(side, level, resting->GetRemainingQuantity(), true);
+
+            orders_.Insert(resting->GetOrderId(), resting);
+            if (type == OrderType::GoodForDay) dayOrders_.Schedule(NextSessionClose(), order.GetOrderId());
+            if (!crosses) {
+                EmitLevelUpdate(side, price, level.quantity_);
+                return;
+            }
+
+            // The order's level was empty before, so it gets one delta, after matching, for what rests
+            MatchOrder(order.GetOrderId(), order.GetOrderType(), side);
+            if (type == OrderType::FillAndKill || type == OrderType::FillOrKill)
+                CancelOrderInternal(order.GetOrderId(), false);   // whatever did not fill; no-op if it all did
+            else if (Order* rest = orders_.Find(order.GetOrderId()))
+                EmitLevelUpdate(side, price, rest->GetRemainingQuantity());
+        }
+
+        // Resting levels of side S, or its trigger levels when Parked
+        template <Side S, bool Parked>
+        auto& LevelsOf() {
+            if constexpr (Parked) return Stops<S>();
+            else return Levels<S>();
+        }
+
+        // Unindexes, reports and frees one order leaving the book in a mass cancel; its level and
+        // the feed are the caller's
+        void ReleaseCancelled(Order* order) {
+            orders_.Erase(order->GetOrderId());
+            ReportCancel(order->GetOrderId(), order->GetSide(), order->GetOrderType(), order->GetPrice(), order->GetRemainingQuantity());
+            pool_.Release(order);
+        }
+
+        // Drops every level of side S priced within [low, high] whole: its queue is walked once
+        // to release the orders and the level goes with one delta, where a cancel per order would
+        // find the level, update its quantity and emit a delta each time. Parked is the same for
+        // pending stops by stop price, which have no deltas.
+        template <Side S, bool Parked>
+        std::size_t CancelLevels(Price low, Price high) {
+            auto& levels = LevelsOf<S, Parked>();
+            std::size_t cancelled = 0;
+            levels.ForEachLevelIn(low, high, [&](Price price, PriceLevel& level) {
+                cancelled += level.orders_.Size();
+                for (Order* order = level.orders_.Front(); order;) {
+                    Order* next = OrderList::Next(order);
+                    ReleaseCancelled(order);
+                    order = next;
                 }
+                level.orders_.Clear();
+                levels.RemoveQuantity(level, level.quantity_);
+                if constexpr (!Parked) EmitLevelUpdate(S, price, 0);
+            });
+            if constexpr (Parked) stopCount_ -= cancelled;
+            return cancelled;
+        }
 
-                if (!asks.empty()) {
-                    auto& order = asks.front();
-                    if (order && order->GetOrderType() == OrderType::FillAndKill) {
-                        CancelOrder(order->GetOrderId());
+        // Takes owner's orders off every level of side S and leaves the rest in place: one walk of
+        // each queue and one delta per level that lost quantity
+        template <Side S, bool Parked>
+        std::size_t CancelOwnerOrders(Owner owner) {
+            auto& levels = LevelsOf<S, Parked>();
+            std::size_t cancelled = 0;
+            levels.ForEachLevelIn(std::numeric_limits<Price>::min(), std::numeric_limits<Price>::max(), [&](Price price, PriceLevel& level) {
+                Quantity removed = 0;
+                bool touched = false;
+                for (Order* order = level.orders_.Front(); order;) {
+                    Order* next = OrderList::Next(order);
+                    if (order->GetOwner() == owner) {
+                        removed += order->GetRemainingQuantity();
+                        touched = true;
+                        ++cancelled;
+                        level.orders_.Erase(order);
+                        ReleaseCancelled(order);
                     }
+                    order = next;
                 }
+                if (!touched) return;
+                levels.RemoveQuantity(level, removed);
+                if constexpr (!Parked) EmitLevelUpdate(S, price, level.quantity_);
+            });
+            if constexpr (Parked) stopCount_ -= cancelled;
+            return cancelled;
+        }
+
+        template <Side S>
+        std::size_t CancelSideInternal() {
+            constexpr Price kLowest = std::numeric_limits<Price>::min();
+            constexpr Price kHighest = std::numeric_limits<Price>::max();
+            return CancelLevels<S, false>(kLowest, kHighest) + CancelLevels<S, true>(kLowest, kHighest);
+        }
+
+        // Same price and side with no more quantity than remains is amended in place and keeps
+        // its place in the queue; anything else loses priority through cancel/replace. A pending
+        // stop is always replaced, keeping its type and stop price.
+        void ModifyOrderInternal(const OrderModify& order) {
+            OrderPointer resting = orders_.Find(order.GetOrderId());
+            if (!resting) {
+                ReportUnknown(order.GetOrderId(), order.GetSide(), order.GetNewPrice(), order.GetNewQuantity());
+                return;
             }
-            return trades;
+
+            if (resting->IsStop()) {
+                Order replacement{ order.GetOrderId(), order.GetNewPrice(), order.GetNewQuantity(), order.GetSide(),
+                    resting->GetOrderType(), resting->GetStopPrice(), resting->GetOwner() };
+                CancelOrderInternal(order.GetOrderId());
+                AddOrderInternal(replacement);
+                return;
+            }
+
+            if (resting->GetPrice() == order.GetNewPrice() && resting->GetSide() == order.GetSide()
+                && order.GetNewQuantity() <= resting->GetRemainingQuantity()) {
+                ReduceOrderInternal(*resting, resting->GetRemainingQuantity() - order.GetNewQuantity());
+                return;
+            }
+
+            OrderType orderType = resting->GetOrderType();
+            Owner owner = resting->GetOwner();
+
+            CancelOrderInternal(order.GetOrderId());
+            AddOrderInternal(order.ToOrder(orderType, owner));
         }
 
-        void CancelOrderInternal(OrderId orderId) {
-            if (!orders_.contains(orderId)) return;
+        void ReduceOrderInternal(Order& order, Quantity quantity) {
+            if (quantity == 0) return;
+            auto* level = order.GetSide() == Side::BID ? _bids.Find(order.GetPrice()) : _asks.Find(order.GetPrice());
+            order.ReduceQuantity(quantity);
+            UpdateLevelData(order.GetSide(), *level, quantity, false);
+            EmitLevelUpdate(order.GetSide(), order.GetPrice(), level->quantity_);
+            listener_.OnCancel(OrderEvent{ order.GetOrderId(), 0, order.GetPrice(), quantity, order.GetRemainingQuantity(),
+                order.GetSide(), order.GetOrderType(), StatusOf(order) });
+        }
 
-            const auto& [order, iterator] = orders_.at(orderId);
-            orders_.erase(orderId);
+        // True when a command at this point of a batch could trade against, reprice or expire a
+        // resting order id on side at price
+        static bool Interferes(const Command& command, OrderId orderId, Side side, Price price, OrderType type) {
+            if (command.orderId_ == orderId) return true;
+            switch (command.type_) {
+            case CommandType::AdvanceClock:
+                return type == OrderType::GoodForDay;
+            case CommandType::Add:
+                if (command.side_ == side) return false;
+                if (command.orderType_ == OrderType::Market) return true;
+                return side == Side::BID ? command.price_ <= price : command.price_ >= price;
+            case CommandType::Modify:
+                if (command.side_ == side) return false;
+                return side == Side::BID ? command.price_ <= price : command.price_ >= price;
+            case CommandType::Cancel:
+                return false;
+            case CommandType::CancelSide:
+            case CommandType::CancelRange:
+            case CommandType::CancelOwner:
+                return true;   // may take the order with it
+            }
+            return true;
+        }
 
-            if (order->GetSide() == Side::BID) {
-                auto& orders = _bids[order->GetPrice()];
-                UpdateDataMap(order->GetPrice(), order->GetRemainingQuantity(), Side::BID, false);
-                orders.erase(iterator);
-                if (orders.empty()) _bids.erase(order->GetPrice());
-            } else {
-                auto& orders = _asks[order->GetPrice()];
-                UpdateDataMap(order->GetPrice(), order->GetRemainingQuantity(), Side::ASK, false);
-                orders.erase(iterator);
-                if (orders.empty()) _asks.erase(order->GetPrice());
+        // Pairs each Cancel with the resting-type Add of the same id a few commands earlier when
+        // nothing in between could touch it. Whether the add would actually rest is only known
+        // when it runs. Cancels of orders from earlier batches give up after the id scan.
+        void FindCollapsiblePairs(std::span<const Command> commands) {
+            batchPartners_.assign(commands.size(), kNoPartner);
+            batchSkipped_.assign(commands.size(), 0);
+            // any trade can fire stops, and what they trade is not known here
+            if (stopCount_ > 0) return;
+            for (const Command& command : commands)
+                if (command.type_ == CommandType::Add && (command.orderType_ == OrderType::Stop || command.orderType_ == OrderType::StopLimit)) return;
+            for (std::size_t j = 1; j < commands.size(); ++j) {
+                const Command& cancel = commands[j];
+                if (cancel.type_ != CommandType::Cancel) continue;
+                std::size_t first = j > kCollapseWindow ? j - kCollapseWindow : 0;
+                std::size_t i = j;
+                while (i > first && commands[i - 1].orderId_ != cancel.orderId_) --i;
+                if (i-- == first) continue;
+                const Command& add = commands[i];
+                if (add.type_ != CommandType::Add) continue;
+                if (add.orderType_ != OrderType::GoodTillCancel && add.orderType_ != OrderType::GoodForDay) continue;
+                std::size_t k = i + 1;
+                while (k < j && !Interferes(commands[k], add.orderId_, add.side_, add.price_, add.orderType_)) ++k;
+                if (k == j) batchPartners_[i] = static_cast<std::uint32_t>(j);
             }
         }
 
-    public:
-        Trades AddOrder(OrderPointer order) {
-            if (orders_.contains(order->GetOrderId())) return {};
-
-            OrderPointers::iterator iterator;
-            if (order->GetSide() == Side::BID) {
-                auto& orders = _bids[order->GetPrice()];
-                orders.push_back(order);
-                iterator = std::prev(orders.end());
-                UpdateDataMap(order->GetPrice(), order->GetRemainingQuantity(), Side::BID, true);
-            } else {
-                auto& orders = _asks[order->GetPrice()];
-                orders.push_back(order);
-                iterator = std::prev(orders.end());
-                UpdateDataMap(order->GetPrice(), order->GetRemainingQuantity(), Side::ASK, true);
+        // An add whose cancel follows with nothing in between able to reach it only has to be
+        // validated: if it would rest without trading, neither command needs to touch the book
+        bool CanCollapse(const Command& add) const {
+            if (orders_.Contains(add.orderId_)) return false;
+            if (CanMatch(add.price_, add.side_)) return false;
+            return add.side_ == Side::BID ? _bids.Accepts(add.price_) : _asks.Accepts(add.price_);
+        }
+
+        void ApplyInternal(const Command& command) {
+            switch (command.type_) {
+            case CommandType::Add:
+                AddOrderInternal(command.ToOrder());
+                break;
+            case CommandType::Cancel:
+                CancelOrRejectInternal(command.orderId_);
+                break;
+            case CommandType::Modify:
+                ModifyOrderInternal(command.ToOrderModify());
+                break;
+            case CommandType::AdvanceClock:
+                AdvanceClock(command.price_);
+                break;
+            case CommandType::CancelSide:
+                CancelSide(command.side_);
+                break;
+            case CommandType::CancelRange:
+                CancelRange(command.side_, command.price_, command.stopPrice_);
+                break;
+            case CommandType::CancelOwner:
+                CancelOwner(command.owner_);
+                break;
             }
+        }
+
+    public:
+        BasicOrderBook() = default;
+
+        explicit BasicOrderBook(Listener listener)
+            : listener_{ std::move(listener) }
+        { }
+
+        // Dense mode: both sides use a tick-indexed ladder; prices outside it are rejected
+        explicit BasicOrderBook(const LadderConfig& ladder, Listener listener = {})
+            : listener_{ std::move(listener) }
+            , _bids{ ladder }
+            , _asks{ ladder }
+        { }
+
+        // Takes over another book's orders and state, reporting to a listener of this type from now on
+        template <OrderListener Other>
+        explicit BasicOrderBook(BasicOrderBook<Other>&& other, Listener listener = {})
+            : listener_{ std::move(listener) }
+            , pool_{ std::move(other.pool_) }
+            , _bids{ std::move(other._bids) }
+            , _asks{ std::move(other._asks) }
+            , orders_{ std::move(other.orders_) }
+            , buyStops_{ std::move(other.buyStops_) }
+            , sellStops_{ std::move(other.sellStops_) }
+            , stopCount_{ other.stopCount_ }
+            , lastPrice_{ other.lastPrice_ }
+            , levelUpdates_{ other.levelUpdates_ }
+            , sequence_{ other.sequence_ }
+            , dayOrders_{ std::move(other.dayOrders_) }
+            , session_{ other.session_ }
+            , clock_{ other.clock_ }
+        { }
+
+        Listener& GetListener() { return listener_; }
+        const Listener& GetListener() const { return listener_; }
+
+        // The order is copied into pooled storage; the caller's object is not retained.
+        // Orders that cannot trade the way their type demands are rejected before touching the book:
+        //  Market       needs a non-empty other side; becomes a limit through its worst level, and any rest stays GoodTillCancel
+        //  FillAndKill  needs to cross; trades at the best opposite level only, whatever does not fill there is cancelled
+        //  FillOrKill   needs enough quantity at acceptable prices to fill completely
+        //  GoodForDay   rests until the next session close (see AdvanceClock)
+        //  Stop         waits off the book, without trading, until a trade prints at or through its stop
+        //  StopLimit    price (at or above for a buy, at or below for a sell), then enters as a Market or
+        //               as a GoodTillCancel at its limit price, keeping its id and quantity
+        // Every outcome is reported to the listener, nothing is collected
+        void Add(const Order& order) {
+            AddOrderInternal(order);
+        }
+
+        // Add, also returning the order's fills
+        Trades AddOrder(const Order& order) {
+            Trades trades;
+            TradeCapture capture{ *this, trades };
+            AddOrderInternal(order);
+            return trades;
+        }
+
+        // Moves the book's clock forward and cancels, in one pass over the due timers, every
+        // GoodForDay order whose session has closed
+        void AdvanceClock(Timestamp now) {
+            if (now <= clock_) return;
+            clock_ = now;
+            dayOrders_.Advance(now, [this](OrderId orderId) {
+                // timers are not removed on cancel or fill: skip ids that are gone or were reused.
+                // A live GoodForDay order always expires at the same close as any stale timer for its id.
+                OrderPointer order = orders_.Find(orderId);
+                if (order && order->GetOrderType() == OrderType::GoodForDay)
+                    CancelOrderInternal(orderId);
+            });
+        }
+
+        Timestamp GetClock() const { return clock_; }
 
-            orders_.insert({order->GetOrderId(), OrderEntry{order, iterator}});
-            return MatchOrder();
+        // GoodForDay orders already resting are re-armed to expire at the new schedule's next
+        // close, which costs a walk of the book when any are pending
+        void SetSessionSchedule(const SessionSchedule& session) {
+            session_ = session;
+            if (dayOrders_.Size() == 0) return;
+            dayOrders_ = TimerWheel<OrderId>{};
+            dayOrders_.Advance(clock_, [](OrderId) { });   // start the new wheel at the book's clock
+            Timestamp close = NextSessionClose();
+            ForEachOrder([&](const Order& order) {
+                if (order.GetOrderType() == OrderType::GoodForDay) dayOrders_.Schedule(close, order.GetOrderId());
+            });
         }
+        const SessionSchedule& GetSessionSchedule() const { return session_; }
 
+        // An unknown id is reported as a reject
         void CancelOrder(OrderId orderId) {
-            CancelOrderInternal(orderId);
+            CancelOrRejectInternal(orderId);
+        }
+
+        // Mass cancels, for pulling quotes in bulk. Every order cancelled is reported to the
+        // listener, but the feed gets one delta per level (0 for a level dropped whole), not one
+        // per order, and levels are released whole instead of order by order. Each returns how
+        // many orders it cancelled; an empty selection is not an error.
+
+        // Every resting order and pending stop on side
+        std::size_t CancelSide(Side side) {
+            return side == Side::BID ? CancelSideInternal<Side::BID>() : CancelSideInternal<Side::ASK>();
+        }
+
+        // Every resting order on side priced within [low, high]; pending stops stay
+        std::size_t CancelRange(Side side, Price low, Price high) {
+            return side == Side::BID ? CancelLevels<Side::BID, false>(low, high) : CancelLevels<Side::ASK, false>(low, high);
+        }
+
+        // Every resting order and pending stop entered under owner. There is no index by owner,
+        // so this walks the whole book, but it skips other owners' orders without touching the
+        // order index, and levels are still updated once each. Owner 0 is untagged flow, never a
+        // mass cancel target: it throws without touching the book.
+        std::size_t CancelOwner(Owner owner) {
+            if (owner == 0) throw std::invalid_argument("Owner 0 is untagged and cannot be mass cancelled");
+            return CancelOwnerOrders<Side::BID, false>(owner) + CancelOwnerOrders<Side::ASK, false>(owner)
+                + CancelOwnerOrders<Side::BID, true>(owner) + CancelOwnerOrders<Side::ASK, true>(owner);
+        }
+
+        void Modify(const OrderModify& order) {
+            ModifyOrderInternal(order);
         }
 
         Trades ModifyOrder(OrderModify order) {
-            if (!orders_.contains(order.GetOrderId())) return {};
+            Trades trades;
+            TradeCapture capture{ *this, trades };
+            ModifyOrderInternal(order);
+            return trades;
+        }
 
-            const auto& [existingOrder, _] = orders_.at(order.GetOrderId());
-            OrderType orderType = existingOrder->GetOrderType();
+        void Apply(const Command& command) {
+            ApplyInternal(command);
+        }
 
-            CancelOrder(order.GetOrderId());
-            return AddOrder(order.ToOrderPointer(orderType));
+        // Applies one command, appending its fills to trades
+        void Apply(const Command& command, Trades& trades) {
+            TradeCapture capture{ *this, trades };
+            ApplyInternal(command);
         }
 
-        LevelInfos GetBids(size_t levels) const {
-            LevelInfos result;
-            size_t count = 0;
-            for (const auto& [price, orders] : _bids) {
-                if (count >= levels) break;
-                Quantity totalQuantity = 0;
-                for (const auto& order : orders) {
-                    totalQuantity += order->GetRemainingQuantity();
+        // Applies commands in order as one unit of work, appending fills and level deltas to out
+        // (which is not cleared; see BatchResult::Clear). A command that throws is counted in
+        // rejected_ and the batch carries on. Add/Cancel pairs for an order that would only have
+        // rested are dropped without touching the book, so their deltas never appear and the
+        // delta sequence advances less than per-command application would; the resulting book is
+        // the same. Commands are not filtered by symbol_.
+        void ProcessBatch(std::span<const Command> commands, BatchResult& out) {
+            FindCollapsiblePairs(commands);
+            LevelUpdates* sink = levelUpdates_;
+            levelUpdates_ = &out.levelUpdates_;
+            TradeCapture capture{ *this, out.trades_ };
+            out.tradeEnds_.reserve(out.tradeEnds_.size() + commands.size());
+            for (std::size_t i = 0; i < commands.size(); ++i) {
+                const Command& command = commands[i];
+                if (batchSkipped_[i]) {
+                    out.tradeEnds_.push_back(static_cast<std::uint32_t>(out.trades_.size()));
+                    continue;
+                }
+                std::uint32_t partner = batchPartners_[i];
+                if (partner != kNoPartner && CanCollapse(command)) {
+                    // the order's whole life, reported where the add was
+                    ReportAccept(command.orderId_, command.side_, command.orderType_, command.price_, command.quantity_);
+                    ReportCancel(command.orderId_, command.side_, command.orderType_, command.price_, command.quantity_);
+                    batchSkipped_[partner] = 1;
+                    ++out.collapsed_;
+                    out.tradeEnds_.push_back(static_cast<std::uint32_t>(out.trades_.size()));
+                    continue;
                 }
-                result.push_back({price, totalQuantity});
-                count++;
+                try {
+                    ApplyInternal(command);
+                } catch (const std::exception&) {
+                    ++out.rejected_;
+                }
+                out.tradeEnds_.push_back(static_cast<std::uint32_t>(out.trades_.size()));
+            }
+            levelUpdates_ = sink;
+        }
+
+        // Pre-size order storage so the first count resting orders never touch the heap
+        void ReserveOrders(std::size_t count) {
+            pool_.Reserve(count);
+            orders_.Reserve(count);
+        }
+
+        bool IsDense() const { return _bids.IsDense(); }
+        std::optional<LadderConfig> GetLadderConfig() const { return _bids.GetLadderConfig(); }
+
+        // Calls f(order) for every order on the book: bids then asks, each in priority order, then
+        // pending buy and sell stops, each in trigger order
+        template <typename F>
+        void ForEachOrder(F&& f) const {
+            auto visit = [&](Price, const PriceLevel& level) {
+                for (const Order* order = level.orders_.Front(); order; order = OrderList::Next(order)) f(*order);
+                return true;
+            };
+            _bids.ForEachLevel(visit);
+            _asks.ForEachLevel(visit);
+            buyStops_.ForEachLevel(visit);
+            sellStops_.ForEachLevel(visit);
+        }
+
+        // Recovery only: appends an order to the back of its level as it was when checkpointed,
+        // without matching or emitting deltas. Orders must be restored in ForEachOrder order,
+        // after the clock and session schedule.
+        void RestoreOrder(const Order& order) {
+            if (orders_.Contains(order.GetOrderId()))
+                throw std::logic_error(std::format("Order ({}) is already on the book.", order.GetOrderId()));
+            if (order.IsStop()) {
+                OrderPointer stop = pool_.Acquire(order.GetOrderId(), order.GetPrice(), order.GetRemainingQuantity(),
+                    order.GetSide(), order.GetOrderType(), order.GetStopPrice(), order.GetOwner());
+                if (order.GetSide() == Side::BID) ParkStop<Side::BID>(stop);
+                else ParkStop<Side::ASK>(stop);
+                return;
             }
+            auto& level = order.GetSide() == Side::BID
+                ? _bids.GetOrCreate(order.GetPrice())
+                : _asks.GetOrCreate(order.GetPrice());
+            OrderPointer resting = pool_.Acquire(
+                order.GetOrderId(),
+                order.GetPrice(),
+                order.GetInitialQuantity(),
+                order.GetSide(),
+                order.GetOrderType(),
+                0,
+                order.GetOwner()
+            );
+            resting->FillOrder(order.GetInitialQuantity() - order.GetRemainingQuantity());
+            level.orders_.PushBack(resting);
+            UpdateLevelData(order.GetSide(), level, resting->GetRemainingQuantity(), true);
+            orders_.Insert(resting->GetOrderId(), resting);
+            if (order.GetOrderType() == OrderType::GoodForDay) dayOrders_.Schedule(NextSessionClose(), order.GetOrderId());
+        }
+
+        void RestoreSequence(std::uint64_t sequence) { sequence_ = sequence; }
+        void RestoreLastPrice(std::optional<Price> price) { lastPrice_ = price; }
+
+        // Resting orders and pending stops
+        std::size_t Size() const { return orders_.Size(); }
+        std::size_t GetStopCount() const { return stopCount_; }
+
+        // Price of the last trade, which stops trigger on; nullopt before the first
+        std::optional<Price> GetLastPrice() const { return lastPrice_; }
+
+        // Level deltas are appended to sink as they happen; nullptr turns the feed off
+        void SetLevelUpdateSink(LevelUpdates* sink) { levelUpdates_ = sink; }
+        std::uint64_t GetSequence() const { return sequence_; }
+
+        // Full depth keyed by the sequence number of the last emitted delta
+        L2Snapshot GetL2Snapshot() const {
+            return L2Snapshot{ sequence_, GetBids(static_cast<size_t>(-1)), GetAsks(static_cast<size_t>(-1)) };
+        }
+        const OrderPool& GetOrderPool() const { return pool_; }
+        OrderPool& GetOrderPool() { return pool_; }
+
+        // Top of a side; quantity_ is 0 when the side is empty
+        LevelInfo GetBestBid() const {
+            if (_bids.Empty()) return {0, 0};
+            return {_bids.BestPrice(), _bids.BestLevel().quantity_};
+        }
+
+        LevelInfo GetBestAsk() const {
+            if (_asks.Empty()) return {0, 0};
+            return {_asks.BestPrice(), _asks.BestLevel().quantity_};
+        }
+
+        // Resting quantity on side priced within distance of its best price
+        std::uint64_t GetDepthWithin(Side side, Price distance) const {
+            return side == Side::BID ? _bids.DepthWithin(distance) : _asks.DepthWithin(distance);
+        }
+
+        // Worst price on side that an order taking quantity from it would reach; nullopt if the
+        // side holds less than quantity
+        std::optional<Price> GetSweepPrice(Side side, std::uint64_t quantity) const {
+            return side == Side::BID ? _bids.SweepPrice(quantity) : _asks.SweepPrice(quantity);
+        }
+
+        // Fill out with the best out.size() levels per side without allocating; returns how many were written
+        std::size_t GetBids(std::span<LevelInfo> out) const {
+            std::size_t count = 0;
+            _bids.ForEachLevel([&](Price price, const PriceLevel& level) {
+                if (count >= out.size()) return false;
+                out[count++] = {price, level.quantity_};
+                return true;
+            });
+            return count;
+        }
+
+        std::size_t GetAsks(std::span<LevelInfo> out) const {
+            std::size_t count = 0;
+            _asks.ForEachLevel([&](Price price, const PriceLevel& level) {
+                if (count >= out.size()) return false;
+                out[count++] = {price, level.quantity_};
+                return true;
+            });
+            return count;
+        }
+
+        LevelInfos GetBids(size_t levels) const {
+            LevelInfos result;
+            _bids.ForEachLevel([&](Price price, const PriceLevel& level) {
+                if (result.size() >= levels) return false;
+                result.push_back({price, level.quantity_});
+                return true;
+            });
             return result;
         }
 
         LevelInfos GetAsks(size_t levels) const {
             LevelInfos result;
-            size_t count = 0;
-            for (const auto& [price, orders] : _asks) {
-                if (count >= levels) break;
-                Quantity totalQuantity = 0;
-                for (const auto& order : orders) {
-                    totalQuantity += order->GetRemainingQuantity();
-                }
-                result.push_back({price, totalQuantity});
-                count++;
-            }
+            _asks.ForEachLevel([&](Price price, const PriceLevel& level) {
+                if (result.size() >= levels) return false;
+                result.push_back({price, level.quantity_});
+                return true;
+            });
             return result;
         }
-};
\ No newline at end of file
+};
+
+using OrderBook = BasicOrderBook<>;
+
+// A command's fills as a vector, for callers that want one per command
+template <OrderListener Listener>
+Trades ApplyCommand(BasicOrderBook<Listener>& book, const Command& command) {
+    Trades trades;
+    book.Apply(command, trades);
+    return trades;
+}
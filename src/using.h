@@ -12,7 +12,8 @@ enum class OrderStatus
 	FILLED,
 	NEW,
 	PARTIALLY_FILLED, 
-	CANCELLED
+	CANCELLED,
+	REJECTED
 };
 enum class OrderType
 {
@@ -20,9 +21,14 @@ enum class OrderType
 	FillAndKill,
 	FillOrKill,
 	GoodForDay,
-	Market
+	Market,
+	Stop,        // parked until the last trade reaches its stop price, then a Market order
+	StopLimit    // parked likewise, then a GoodTillCancel at its limit price
 };
 
 using Price = std::int64_t;
 using Quantity = std::uint32_t;
 using OrderId = std::uint64_t;
+using Symbol = std::uint32_t;
+using Timestamp = std::int64_t;   // nanoseconds since the epoch
+using Owner = std::uint32_t;      // account or session tag an order was entered under; 0 = untagged